@@ -187,14 +187,18 @@ class BinaryHeap {
                 const ptr = Module._heapGetArray();
                 if (!ptr || ptr === 0) return this.heap;
                 
-                // Read from WebAssembly memory
+                // Read from WebAssembly memory. Binaries built with the
+                // result-buffer protocol (they export heapGetArrayInto) return
+                // a view into the heap's own storage, which must not be freed;
+                // older ones return a fresh copy that the caller frees.
+                const ownsCopy = !Module._heapGetArrayInto;
                 // Try HEAP32 first (standard Emscripten way)
                 if (typeof HEAP32 !== 'undefined' && HEAP32) {
                     const arr = [];
                     for (let i = 0; i < size; i++) {
                         arr.push(HEAP32[(ptr >> 2) + i]);
                     }
-                    if (Module._free) Module._free(ptr);
+                    if (ownsCopy && Module._free) Module._free(ptr);
                     return arr;
                 }
                 
@@ -203,7 +207,7 @@ class BinaryHeap {
                 if (wasmMemory) {
                     const view = new Int32Array(wasmMemory.buffer, ptr, size);
                     const arr = Array.from(view);
-                    if (Module._free) Module._free(ptr);
+                    if (ownsCopy && Module._free) Module._free(ptr);
                     return arr;
                 }
                 
@@ -213,12 +217,11 @@ class BinaryHeap {
                     for (let i = 0; i < size; i++) {
                         arr.push(Module.HEAP32[(ptr >> 2) + i]);
                     }
-                    if (Module._free) Module._free(ptr);
+                    if (ownsCopy && Module._free) Module._free(ptr);
                     return arr;
                 }
                 
-                // If all else fails, free and return JS heap
-                if (Module._free) Module._free(ptr);
+                // If all else fails, return JS heap
                 return this.heap;
             } catch (e) {
                 console.error('WASM getArray error, using JS fallback:', e);
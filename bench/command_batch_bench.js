@@ -0,0 +1,86 @@
+// Compares per-call exports with the command ring under Node.
+//
+//   node bench/command_batch_bench.js [operations] [batch size]
+//
+// Each workload runs the same operations twice: once through one cwrap call
+// per operation, once queued in a CommandBatch and flushed every batch-size
+// operations. Needs a ds_visualizer.js built with command_batch.cpp and the
+// HEAP views exported (see the README).
+const path = require('path');
+const { loadWasmNode, wasmFunctions, CommandBatch, CommandOp, getModule } = require('../wasm-wrapper.js');
+
+const operations = parseInt(process.argv[2], 10) || 200000;
+const batchSize = parseInt(process.argv[3], 10) || 1024;
+
+function time(run) {
+    // Warm up once so both paths are measured with optimized JS
+    run();
+    const start = process.hrtime.bigint();
+    run();
+    return Number(process.hrtime.bigint() - start) / 1e9;
+}
+
+const keys = Array.from({ length: 1024 }, (_, i) => 'key' + i);
+
+const workloads = [
+    {
+        name: 'heap insert',
+        perCall() {
+            wasmFunctions.createHeap(1);
+            for (let i = 0; i < operations; i++) wasmFunctions.heapInsert(i * 7919 % 100003);
+        },
+        batched(batch) {
+            batch.push(CommandOp.HEAP_CREATE, 1);
+            for (let i = 0; i < operations; i++) {
+                batch.push(CommandOp.HEAP_INSERT, i * 7919 % 100003);
+                if ((i + 1) % batchSize === 0) batch.flush();
+            }
+            batch.flush();
+        }
+    },
+    {
+        name: 'hash insert+search',
+        perCall() {
+            wasmFunctions.createHashTable(1031, 1);
+            for (let i = 0; i < operations; i++) {
+                const key = keys[i % keys.length];
+                if (i & 1) {
+                    wasmFunctions.hashTableSearch(key);
+                } else {
+                    wasmFunctions.hashTableInsert(key, 'value' + i);
+                }
+            }
+        },
+        batched(batch) {
+            batch.push(CommandOp.HASH_CREATE, 1031, 1);
+            for (let i = 0; i < operations; i++) {
+                const key = keys[i % keys.length];
+                if (i & 1) {
+                    batch.hashSearch(key);
+                } else {
+                    batch.hashInsert(key, 'value' + i);
+                }
+                if ((i + 1) % batchSize === 0) batch.flush();
+            }
+            batch.flush();
+        }
+    }
+];
+
+loadWasmNode(path.join(__dirname, '..', 'ds_visualizer.js')).then(() => {
+    if (!wasmFunctions.executeBatch || !getModule().HEAP32) {
+        console.error('ds_visualizer.js has no executeBatch export or HEAP views; rebuild it as described in README.md');
+        process.exit(1);
+    }
+    const batch = new CommandBatch(batchSize, 1 << 16);
+    console.log(`${operations} operations, batch size ${batchSize}`);
+    console.log('workload'.padEnd(20) + 'per-call ops/s'.padStart(16) + 'batched ops/s'.padStart(16) + 'speedup'.padStart(10));
+    for (const workload of workloads) {
+        const perCall = operations / time(() => workload.perCall());
+        const batched = operations / time(() => workload.batched(batch));
+        console.log(workload.name.padEnd(20) +
+            Math.round(perCall).toLocaleString().padStart(16) +
+            Math.round(batched).toLocaleString().padStart(16) +
+            (batched / perCall).toFixed(2).padStart(9) + 'x');
+    }
+});
@@ -1,5 +1,8 @@
 #include <algorithm>
+#include <vector>
 #include <emscripten.h>
+#include "ds_stats.h"
+#include "ds_result_buffer.h"
 
 struct AVLNode {
     int value;
@@ -10,9 +13,28 @@ struct AVLNode {
     AVLNode(int val) : value(val), left(nullptr), right(nullptr), height(1) {}
 };
 
+#if DS_ENABLE_STATS
+struct AVLStats {
+    uint64_t inserts = 0;
+    uint64_t deletes = 0;
+    uint64_t rotationsLeft = 0;
+    uint64_t rotationsRight = 0;
+    // Nodes whose height was recomputed on the way back up, per operation
+    DSHistogram retraceDepth;
+    DSHistogram insertNanos;
+    DSHistogram deleteNanos;
+    uint64_t currentRetrace = 0;
+};
+#endif
+
 class AVLTree {
 private:
     AVLNode* root;
+    // Reused by every traversal so repeated calls do not allocate
+    std::vector<int> traversal;
+#if DS_ENABLE_STATS
+    AVLStats stats;
+#endif
 
     int getHeight(AVLNode* node) {
         return node ? node->height : 0;
@@ -27,6 +49,7 @@ private:
     }
 
     AVLNode* rotateRight(AVLNode* y) {
+        DS_STAT(stats.rotationsRight++);
         AVLNode* x = y->left;
         AVLNode* T2 = x->right;
 
@@ -40,6 +63,7 @@ private:
     }
 
     AVLNode* rotateLeft(AVLNode* x) {
+        DS_STAT(stats.rotationsLeft++);
         AVLNode* y = x->right;
         AVLNode* T2 = y->left;
 
@@ -64,6 +88,7 @@ private:
         }
 
         updateHeight(node);
+        DS_STAT(stats.currentRetrace++);
         int balance = getBalance(node);
 
         // Left Left
@@ -121,6 +146,7 @@ private:
         }
 
         updateHeight(node);
+        DS_STAT(stats.currentRetrace++);
         int balance = getBalance(node);
 
         // Left Left
@@ -148,6 +174,27 @@ private:
         return node;
     }
 
+    void inorder(AVLNode* node) {
+        if (!node) return;
+        inorder(node->left);
+        traversal.push_back(node->value);
+        inorder(node->right);
+    }
+
+    void preorder(AVLNode* node) {
+        if (!node) return;
+        traversal.push_back(node->value);
+        preorder(node->left);
+        preorder(node->right);
+    }
+
+    void postorder(AVLNode* node) {
+        if (!node) return;
+        postorder(node->left);
+        postorder(node->right);
+        traversal.push_back(node->value);
+    }
+
     void clearTree(AVLNode* node) {
         if (node) {
             clearTree(node->left);
@@ -160,11 +207,17 @@ public:
     AVLTree() : root(nullptr) {}
 
     void insert(int value) {
+        DS_STAT_TIMER(stats.insertNanos);
+        DS_STAT(stats.inserts++; stats.currentRetrace = 0);
         root = insert(root, value);
+        DS_STAT(stats.retraceDepth.record(stats.currentRetrace));
     }
 
     void deleteNode(int value) {
+        DS_STAT_TIMER(stats.deleteNanos);
+        DS_STAT(stats.deletes++; stats.currentRetrace = 0);
         root = deleteNode(root, value);
+        DS_STAT(stats.retraceDepth.record(stats.currentRetrace));
     }
 
     void clear() {
@@ -175,6 +228,41 @@ public:
     AVLNode* getRoot() {
         return root;
     }
+
+    // The returned vector is reused by the next traversal
+    std::vector<int>& inorder() {
+        traversal.clear();
+        inorder(root);
+        return traversal;
+    }
+
+    std::vector<int>& preorder() {
+        traversal.clear();
+        preorder(root);
+        return traversal;
+    }
+
+    std::vector<int>& postorder() {
+        traversal.clear();
+        postorder(root);
+        return traversal;
+    }
+
+#if DS_ENABLE_STATS
+    std::string statsJSON() {
+        return DSStatsWriter()
+            .counter("inserts", stats.inserts)
+            .counter("deletes", stats.deletes)
+            .counter("rotationsLeft", stats.rotationsLeft)
+            .counter("rotationsRight", stats.rotationsRight)
+            .histogram("retraceDepth", stats.retraceDepth)
+            .histogram("insertNanos", stats.insertNanos)
+            .histogram("deleteNanos", stats.deleteNanos)
+            .finish();
+    }
+
+    void resetStats() { stats = AVLStats(); }
+#endif
 };
 
 static AVLTree* avlTree = nullptr;
@@ -201,5 +289,69 @@ extern "C" {
     void avlClear() {
         if (avlTree) avlTree->clear();
     }
-}
 
+    // Traversals follow the protocol in ds_result_buffer.h
+    EMSCRIPTEN_KEEPALIVE
+    int* avlInorder(int* size) {
+        if (!avlTree) {
+            *size = 0;
+            return nullptr;
+        }
+        return resultView(avlTree->inorder(), size);
+    }
+
+    EMSCRIPTEN_KEEPALIVE
+    int avlInorderInto(int* out, int capacity) {
+        if (!avlTree) return 0;
+        return resultInto(avlTree->inorder(), out, capacity);
+    }
+
+    EMSCRIPTEN_KEEPALIVE
+    int* avlPreorder(int* size) {
+        if (!avlTree) {
+            *size = 0;
+            return nullptr;
+        }
+        return resultView(avlTree->preorder(), size);
+    }
+
+    EMSCRIPTEN_KEEPALIVE
+    int avlPreorderInto(int* out, int capacity) {
+        if (!avlTree) return 0;
+        return resultInto(avlTree->preorder(), out, capacity);
+    }
+
+    EMSCRIPTEN_KEEPALIVE
+    int* avlPostorder(int* size) {
+        if (!avlTree) {
+            *size = 0;
+            return nullptr;
+        }
+        return resultView(avlTree->postorder(), size);
+    }
+
+    EMSCRIPTEN_KEEPALIVE
+    int avlPostorderInto(int* out, int capacity) {
+        if (!avlTree) return 0;
+        return resultInto(avlTree->postorder(), out, capacity);
+    }
+
+    // Returned string stays valid until the next avlGetStats call
+    EMSCRIPTEN_KEEPALIVE
+    const char* avlGetStats() {
+#if DS_ENABLE_STATS
+        static std::string json;
+        json = avlTree ? avlTree->statsJSON() : DSStatsWriter().finish();
+        return json.c_str();
+#else
+        return DS_STATS_DISABLED_JSON;
+#endif
+    }
+
+    EMSCRIPTEN_KEEPALIVE
+    void avlResetStats() {
+#if DS_ENABLE_STATS
+        if (avlTree) avlTree->resetStats();
+#endif
+    }
+}
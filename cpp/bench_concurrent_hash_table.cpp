@@ -0,0 +1,100 @@
+// Native read-scaling benchmark for the concurrent hash table.
+//
+//   g++ -std=c++17 -O2 -pthread -o bench_concurrent_hash_table
+//       cpp/concurrent_hash_table.cpp cpp/bench_concurrent_hash_table.cpp
+//   ./bench_concurrent_hash_table [seconds per run] [keys] [max threads]
+//
+// Runs 95/5 and 50/50 read/write mixes at 1, 2, 4, ... threads over a
+// preloaded key set. Writes alternate between updating and deleting then
+// re-inserting a key, so retired entries keep flowing through reclamation.
+// Reports total throughput and the speedup over one thread.
+
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <string>
+#include <thread>
+#include <vector>
+
+extern "C" {
+    void createConcurrentHashTable(int shardCount);
+    void concurrentHashTableInsert(const char* key, const char* value);
+    int concurrentHashTableSearch(const char* key, char* out, int capacity);
+    int concurrentHashTableDelete(const char* key);
+}
+
+// Returns operations per second across all threads
+static double runMix(int threads, int readPercent, double seconds, const std::vector<std::string>& keys) {
+    std::atomic<bool> start{false};
+    std::atomic<bool> stop{false};
+    std::vector<uint64_t> ops(threads, 0);
+    std::vector<std::thread> workers;
+
+    for (int t = 0; t < threads; t++) {
+        workers.emplace_back([&, t] {
+            uint64_t state = 0x9E3779B97F4A7C15ULL * (t + 1);
+            char value[32];
+            uint64_t done = 0;
+            while (!start.load(std::memory_order_acquire)) std::this_thread::yield();
+            while (!stop.load(std::memory_order_relaxed)) {
+                // xorshift64
+                state ^= state << 13;
+                state ^= state >> 7;
+                state ^= state << 17;
+                const char* key = keys[state % keys.size()].c_str();
+                if (static_cast<int>((state >> 32) % 100) < readPercent) {
+                    concurrentHashTableSearch(key, value, sizeof(value));
+                } else if ((state >> 40) & 1) {
+                    snprintf(value, sizeof(value), "v%llu", static_cast<unsigned long long>(done));
+                    concurrentHashTableInsert(key, value);
+                } else {
+                    concurrentHashTableDelete(key);
+                    concurrentHashTableInsert(key, "value");
+                }
+                done++;
+            }
+            ops[t] = done;
+        });
+    }
+
+    auto begin = std::chrono::steady_clock::now();
+    start.store(true, std::memory_order_release);
+    std::this_thread::sleep_for(std::chrono::duration<double>(seconds));
+    stop.store(true);
+    for (std::thread& worker : workers) worker.join();
+    double elapsed = std::chrono::duration<double>(std::chrono::steady_clock::now() - begin).count();
+
+    uint64_t total = 0;
+    for (uint64_t count : ops) total += count;
+    return total / elapsed;
+}
+
+int main(int argc, char** argv) {
+    double seconds = argc > 1 ? atof(argv[1]) : 1.0;
+    int keyCount = argc > 2 ? atoi(argv[2]) : 100000;
+    int maxThreads = argc > 3 ? atoi(argv[3]) : static_cast<int>(std::thread::hardware_concurrency());
+    if (seconds <= 0) seconds = 1.0;
+    if (keyCount < 1) keyCount = 1;
+    if (maxThreads < 1) maxThreads = 1;
+
+    std::vector<std::string> keys;
+    for (int i = 0; i < keyCount; i++) keys.push_back("key" + std::to_string(i));
+
+    printf("%d keys, %.1fs per run, hardware threads: %u\n", keyCount, seconds, std::thread::hardware_concurrency());
+    const int mixes[] = {95, 50};
+    for (int readPercent : mixes) {
+        printf("\n%d/%d read/write\n", readPercent, 100 - readPercent);
+        printf("%8s %14s %9s\n", "threads", "Mops/s", "speedup");
+        double single = 0;
+        for (int threads = 1; threads <= maxThreads; threads *= 2) {
+            createConcurrentHashTable(16);
+            for (const std::string& key : keys) concurrentHashTableInsert(key.c_str(), "value");
+            double opsPerSecond = runMix(threads, readPercent, seconds, keys);
+            if (threads == 1) single = opsPerSecond;
+            printf("%8d %14.2f %8.2fx\n", threads, opsPerSecond / 1e6, opsPerSecond / single);
+        }
+    }
+    return 0;
+}
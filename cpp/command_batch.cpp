@@ -0,0 +1,251 @@
+#include <cstdint>
+#include <cstring>
+#include <vector>
+#include <emscripten.h>
+
+// Command ring shared with JavaScript.
+//
+// JS writes fixed-size commands into the ring at writeIndex, copies any
+// strings they need into the arena, then calls executeBatch(n) once. Each
+// command's result lands in the result ring at the same slot. Indices grow
+// without bound and are masked by capacity - 1, so capacity must be a power
+// of two. Hash table keys and values are byte offsets of NUL-terminated
+// strings in the arena; JS resets arenaUsed after each batch.
+//
+// Strings a command returns are copied into the out area, since the table
+// entry they came from may be freed by a later command in the same batch.
+// The result holds the offset and length. The out area is reset at the
+// start of every executeBatch, so JS must read it before the next call.
+
+enum CommandOpcode : int32_t {
+    CMD_HEAP_CREATE = 1,      // a = isMin
+    CMD_HEAP_INSERT,          // a = value
+    CMD_HEAP_DELETE,          // -> value = removed root
+    CMD_HEAP_CLEAR,
+    CMD_HEAP_SIZE,            // -> value = size
+
+    CMD_AVL_CREATE = 16,
+    CMD_AVL_INSERT,           // a = value
+    CMD_AVL_DELETE,           // a = value
+    CMD_AVL_CLEAR,
+
+    CMD_GRAPH_CREATE = 32,
+    CMD_GRAPH_ADD_NODE,       // a = node
+    CMD_GRAPH_REMOVE_NODE,    // a = node
+    CMD_GRAPH_ADD_EDGE,       // a = from, b = to, c = weight
+    CMD_GRAPH_REMOVE_EDGE,    // a = from, b = to
+    CMD_GRAPH_CLEAR,
+
+    CMD_HASH_CREATE = 48,     // a = size, b = useChaining
+    CMD_HASH_INSERT,          // a = key offset, b = value offset
+    CMD_HASH_SEARCH,          // a = key offset -> value = out offset or -1, length
+    CMD_HASH_DELETE,          // a = key offset -> value = 1 if removed
+    CMD_HASH_CLEAR,
+};
+
+enum CommandStatus : int32_t {
+    CMD_OK = 0,
+    CMD_UNKNOWN_OPCODE = -1,
+    CMD_BAD_OFFSET = -2,
+    CMD_OUT_OF_SPACE = -3,
+};
+
+struct Command {
+    int32_t opcode;
+    int32_t a;
+    int32_t b;
+    int32_t c;
+};
+
+struct CommandResult {
+    int32_t status;
+    int32_t value;
+    int32_t length;
+};
+
+// Field order is part of the JS contract; see CommandBatch in wasm-wrapper.js
+struct CommandRing {
+    uint32_t capacity;
+    uint32_t readIndex;
+    uint32_t writeIndex;
+    uint32_t arenaCapacity;
+    uint32_t arenaUsed;
+    Command* commands;
+    CommandResult* results;
+    char* arena;
+    uint32_t outCapacity;
+    uint32_t outUsed;
+    char* out;
+};
+
+extern "C" {
+    void createHeap(int isMin);
+    void heapInsert(int value);
+    int heapDelete();
+    void heapClear();
+    int heapGetSize();
+
+    void createAVLTree();
+    void avlInsert(int value);
+    void avlDelete(int value);
+    void avlClear();
+
+    void createGraph();
+    void graphAddNode(char node);
+    void graphRemoveNode(char node);
+    void graphAddEdge(char from, char to, int weight);
+    void graphRemoveEdge(char from, char to);
+    void graphClear();
+
+    void createHashTable(int size, int useChaining);
+    void hashTableInsert(const char* key, const char* value);
+    const char* hashTableSearch(const char* key);
+    int hashTableDelete(const char* key);
+    void hashTableClear();
+}
+
+class CommandExecutor {
+private:
+    CommandRing ring;
+    std::vector<Command> commands;
+    std::vector<CommandResult> results;
+    std::vector<char> arena;
+    std::vector<char> out;
+
+    // Arena strings must start inside the arena and be terminated within it
+    const char* arenaString(int32_t offset) {
+        if (offset < 0 || (uint32_t)offset >= ring.arenaUsed || arena[ring.arenaUsed - 1] != '\0') {
+            return nullptr;
+        }
+        return arena.data() + offset;
+    }
+
+    // Copies str into the out area and points result at the copy
+    void returnString(const char* str, CommandResult& result) {
+        if (!str) {
+            result.value = -1;
+            return;
+        }
+        uint32_t length = strlen(str);
+        if (length > ring.outCapacity - ring.outUsed) {
+            result.status = CMD_OUT_OF_SPACE;
+            return;
+        }
+        memcpy(out.data() + ring.outUsed, str, length);
+        result.value = ring.outUsed;
+        result.length = length;
+        ring.outUsed += length;
+    }
+
+    CommandResult execute(const Command& cmd) {
+        CommandResult result = {CMD_OK, 0, 0};
+        switch (cmd.opcode) {
+            case CMD_HEAP_CREATE: createHeap(cmd.a); break;
+            case CMD_HEAP_INSERT: heapInsert(cmd.a); break;
+            case CMD_HEAP_DELETE: result.value = heapDelete(); break;
+            case CMD_HEAP_CLEAR: heapClear(); break;
+            case CMD_HEAP_SIZE: result.value = heapGetSize(); break;
+
+            case CMD_AVL_CREATE: createAVLTree(); break;
+            case CMD_AVL_INSERT: avlInsert(cmd.a); break;
+            case CMD_AVL_DELETE: avlDelete(cmd.a); break;
+            case CMD_AVL_CLEAR: avlClear(); break;
+
+            case CMD_GRAPH_CREATE: createGraph(); break;
+            case CMD_GRAPH_ADD_NODE: graphAddNode((char)cmd.a); break;
+            case CMD_GRAPH_REMOVE_NODE: graphRemoveNode((char)cmd.a); break;
+            case CMD_GRAPH_ADD_EDGE: graphAddEdge((char)cmd.a, (char)cmd.b, cmd.c); break;
+            case CMD_GRAPH_REMOVE_EDGE: graphRemoveEdge((char)cmd.a, (char)cmd.b); break;
+            case CMD_GRAPH_CLEAR: graphClear(); break;
+
+            case CMD_HASH_CREATE: createHashTable(cmd.a, cmd.b); break;
+            case CMD_HASH_INSERT: {
+                const char* key = arenaString(cmd.a);
+                const char* value = arenaString(cmd.b);
+                if (!key || !value) {
+                    result.status = CMD_BAD_OFFSET;
+                } else {
+                    hashTableInsert(key, value);
+                }
+                break;
+            }
+            case CMD_HASH_SEARCH: {
+                const char* key = arenaString(cmd.a);
+                if (!key) {
+                    result.status = CMD_BAD_OFFSET;
+                } else {
+                    returnString(hashTableSearch(key), result);
+                }
+                break;
+            }
+            case CMD_HASH_DELETE: {
+                const char* key = arenaString(cmd.a);
+                if (!key) {
+                    result.status = CMD_BAD_OFFSET;
+                } else {
+                    result.value = hashTableDelete(key);
+                }
+                break;
+            }
+            case CMD_HASH_CLEAR: hashTableClear(); break;
+
+            default: result.status = CMD_UNKNOWN_OPCODE; break;
+        }
+        return result;
+    }
+
+public:
+    CommandExecutor(uint32_t capacity, uint32_t arenaBytes, uint32_t outBytes)
+        : commands(capacity), results(capacity), arena(arenaBytes), out(outBytes) {
+        ring.capacity = capacity;
+        ring.readIndex = 0;
+        ring.writeIndex = 0;
+        ring.arenaCapacity = arenaBytes;
+        ring.arenaUsed = 0;
+        ring.commands = commands.data();
+        ring.results = results.data();
+        ring.arena = arena.data();
+        ring.outCapacity = outBytes;
+        ring.outUsed = 0;
+        ring.out = out.data();
+    }
+
+    CommandRing* getRing() { return &ring; }
+
+    // Runs up to n pending commands and returns how many ran
+    int executeBatch(int n) {
+        uint32_t pending = ring.writeIndex - ring.readIndex;
+        if (n < 0 || (uint32_t)n > pending) n = pending;
+        if (ring.arenaUsed > ring.arenaCapacity) ring.arenaUsed = ring.arenaCapacity;
+        ring.outUsed = 0;
+        uint32_t mask = ring.capacity - 1;
+        for (int i = 0; i < n; i++) {
+            uint32_t slot = (ring.readIndex + i) & mask;
+            results[slot] = execute(commands[slot]);
+        }
+        ring.readIndex += n;
+        return n;
+    }
+};
+
+static CommandExecutor* commandExecutor = nullptr;
+
+extern "C" {
+    // capacity is rounded up to a power of two. Returns the ring header,
+    // which JS reads once to locate the command, result, arena and out
+    // buffers.
+    EMSCRIPTEN_KEEPALIVE
+    CommandRing* commandRingInit(int capacity, int arenaBytes, int outBytes) {
+        uint32_t rounded = 1;
+        while (rounded < (uint32_t)capacity && rounded < (1u << 20)) rounded <<= 1;
+        if (commandExecutor) delete commandExecutor;
+        commandExecutor = new CommandExecutor(rounded, arenaBytes > 0 ? arenaBytes : 0, outBytes > 0 ? outBytes : 0);
+        return commandExecutor->getRing();
+    }
+
+    EMSCRIPTEN_KEEPALIVE
+    int executeBatch(int n) {
+        if (!commandExecutor) return 0;
+        return commandExecutor->executeBatch(n);
+    }
+}
@@ -0,0 +1,398 @@
+#include <algorithm>
+#include <atomic>
+#include <cstdint>
+#include <cstring>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <vector>
+#ifdef __EMSCRIPTEN__
+#include <emscripten.h>
+#else
+#define EMSCRIPTEN_KEEPALIVE
+#endif
+
+// Sharded hash table for read-heavy, multi-threaded lookups.
+//
+// The shard is picked from the high bits of a 64-bit hash and the slot from
+// the low bits. Writers serialize on a per-shard mutex; readers take no lock.
+// Entries are immutable once published: an update installs a new entry and
+// retires the old one. Search copies the value out, so nothing dangles
+// afterwards.
+//
+// Retired memory is reclaimed by epoch. Each reading thread owns a slot on
+// its own cache line and announces the global epoch there for the length of
+// one search. A writer tags what it retires with the current epoch and frees
+// it once every announced epoch is newer, so readers never write to memory
+// another core is reading, and a steady stream of readers cannot stall
+// reclamation the way a single reader count can.
+
+struct ConcurrentEntry {
+    uint64_t hash;
+    std::string key;
+    std::string value;
+};
+
+struct ConcurrentSlotArray {
+    size_t capacity;
+    std::unique_ptr<std::atomic<ConcurrentEntry*>[]> slots;
+
+    explicit ConcurrentSlotArray(size_t cap) : capacity(cap), slots(new std::atomic<ConcurrentEntry*>[cap]) {
+        for (size_t i = 0; i < capacity; i++) {
+            slots[i].store(nullptr, std::memory_order_relaxed);
+        }
+    }
+};
+
+// Epoch 0 in a slot means its thread is not reading.
+struct alignas(64) ReaderSlot {
+    std::atomic<uint64_t> epoch{0};
+    std::atomic<bool> owned{false};
+};
+
+static constexpr int MAX_READER_SLOTS = 128;
+static ReaderSlot readerSlots[MAX_READER_SLOTS];
+static std::atomic<uint64_t> globalEpoch{1};
+
+// Claims a slot for the calling thread on first use and frees it when the
+// thread exits. Threads beyond MAX_READER_SLOTS get none and read under the
+// shard lock instead.
+class ReaderHandle {
+private:
+    ReaderSlot* slot = nullptr;
+
+public:
+    ReaderHandle() {
+        for (ReaderSlot& candidate : readerSlots) {
+            bool expected = false;
+            if (!candidate.owned.load(std::memory_order_relaxed) &&
+                candidate.owned.compare_exchange_strong(expected, true)) {
+                slot = &candidate;
+                break;
+            }
+        }
+    }
+
+    ~ReaderHandle() {
+        if (slot) slot->owned.store(false, std::memory_order_release);
+    }
+
+    ReaderHandle(const ReaderHandle&) = delete;
+    ReaderHandle& operator=(const ReaderHandle&) = delete;
+
+    ReaderSlot* get() { return slot; }
+};
+
+static ReaderSlot* currentReaderSlot() {
+    static thread_local ReaderHandle handle;
+    return handle.get();
+}
+
+class ConcurrentHashTable {
+private:
+    static constexpr size_t INITIAL_SHARD_CAPACITY = 16;
+    // Retired items a shard collects before a writer tries to free them
+    static constexpr size_t RECLAIM_BATCH = 64;
+
+    // Exactly one of entry and table is set
+    struct Retired {
+        uint64_t epoch;
+        ConcurrentEntry* entry;
+        ConcurrentSlotArray* table;
+    };
+
+    // The table pointer is all readers touch, so it gets a line to itself
+    // and writer bookkeeping never invalidates it.
+    struct alignas(64) Shard {
+        std::atomic<ConcurrentSlotArray*> table{nullptr};
+        alignas(64) std::mutex writeLock;
+        size_t used = 0;   // live entries plus tombstones
+        size_t count = 0;  // live entries
+        std::vector<Retired> retired;
+    };
+
+    // Marks a deleted slot so probe chains stay intact.
+    static ConcurrentEntry tombstone;
+
+    int shardBits;
+    std::unique_ptr<Shard[]> shards;
+
+    static uint64_t hashKey(const char* key) {
+        uint64_t hash = 14695981039346656037ULL;
+        for (int i = 0; key[i] != '\0'; i++) {
+            hash ^= static_cast<unsigned char>(key[i]);
+            hash *= 1099511628211ULL;
+        }
+        // Fold the high bits down so slot indices are not shard-correlated
+        return hash ^ (hash >> 29);
+    }
+
+    Shard& shardFor(uint64_t hash) {
+        return shardBits == 0 ? shards[0] : shards[hash >> (64 - shardBits)];
+    }
+
+    // Must be called after the item is unreachable from the shard's table.
+    // Readers that announce a later epoch cannot have seen it.
+    static void retire(Shard& shard, ConcurrentEntry* entry, ConcurrentSlotArray* table) {
+        shard.retired.push_back({globalEpoch.load(), entry, table});
+    }
+
+    // Frees retired memory once no reader can still hold a pointer to it.
+    // Must be called with the shard's write lock held.
+    void reclaim(Shard& shard, bool force = false) {
+        if (shard.retired.empty() || (!force && shard.retired.size() < RECLAIM_BATCH)) return;
+        // Readers arriving from now on announce an epoch newer than every tag
+        uint64_t oldest = globalEpoch.fetch_add(1) + 1;
+        for (ReaderSlot& slot : readerSlots) {
+            uint64_t epoch = slot.epoch.load();
+            if (epoch != 0 && epoch < oldest) oldest = epoch;
+        }
+        size_t kept = 0;
+        for (const Retired& item : shard.retired) {
+            if (item.epoch < oldest) {
+                delete item.entry;
+                delete item.table;
+            } else {
+                shard.retired[kept++] = item;
+            }
+        }
+        shard.retired.resize(kept);
+    }
+
+    ConcurrentSlotArray* grow(Shard& shard, ConcurrentSlotArray* table) {
+        // Rehash in place when the array is mostly tombstones, otherwise double
+        size_t capacity = shard.count * 2 >= table->capacity / 2 ? table->capacity * 2 : table->capacity;
+        ConcurrentSlotArray* next = new ConcurrentSlotArray(capacity);
+        size_t mask = capacity - 1;
+        for (size_t i = 0; i < table->capacity; i++) {
+            ConcurrentEntry* entry = table->slots[i].load(std::memory_order_relaxed);
+            if (!entry || entry == &tombstone) continue;
+            size_t index = entry->hash & mask;
+            while (next->slots[index].load(std::memory_order_relaxed)) {
+                index = (index + 1) & mask;
+            }
+            next->slots[index].store(entry, std::memory_order_relaxed);
+        }
+        shard.table.store(next);
+        retire(shard, nullptr, table);
+        shard.used = shard.count;
+        return next;
+    }
+
+    bool probe(Shard& shard, uint64_t hash, const char* key, std::string& out) {
+        ConcurrentSlotArray* table = shard.table.load();
+        size_t mask = table->capacity - 1;
+        size_t index = hash & mask;
+        for (size_t probes = 0; probes < table->capacity; probes++, index = (index + 1) & mask) {
+            ConcurrentEntry* entry = table->slots[index].load();
+            if (!entry) return false;
+            if (entry != &tombstone && entry->hash == hash && entry->key == key) {
+                out = entry->value;
+                return true;
+            }
+        }
+        return false;
+    }
+
+public:
+    ConcurrentHashTable(int shardCount = 16) : shardBits(0) {
+        while ((1 << shardBits) < shardCount && shardBits < 8) shardBits++;
+        shards.reset(new Shard[1 << shardBits]);
+        for (int i = 0; i < (1 << shardBits); i++) {
+            shards[i].table.store(new ConcurrentSlotArray(INITIAL_SHARD_CAPACITY));
+        }
+    }
+
+    ~ConcurrentHashTable() {
+        for (int i = 0; i < (1 << shardBits); i++) {
+            Shard& shard = shards[i];
+            ConcurrentSlotArray* table = shard.table.load();
+            for (size_t j = 0; j < table->capacity; j++) {
+                ConcurrentEntry* entry = table->slots[j].load();
+                if (entry && entry != &tombstone) delete entry;
+            }
+            delete table;
+            for (const Retired& item : shard.retired) {
+                delete item.entry;
+                delete item.table;
+            }
+        }
+    }
+
+    ConcurrentHashTable(const ConcurrentHashTable&) = delete;
+    ConcurrentHashTable& operator=(const ConcurrentHashTable&) = delete;
+
+    void insert(const char* key, const char* value) {
+        uint64_t hash = hashKey(key);
+        Shard& shard = shardFor(hash);
+        std::lock_guard<std::mutex> guard(shard.writeLock);
+
+        ConcurrentSlotArray* table = shard.table.load(std::memory_order_relaxed);
+        if ((shard.used + 1) * 4 > table->capacity * 3) {
+            table = grow(shard, table);
+        }
+
+        size_t mask = table->capacity - 1;
+        size_t index = hash & mask;
+        size_t firstFree = table->capacity;
+        for (size_t probes = 0; probes < table->capacity; probes++, index = (index + 1) & mask) {
+            ConcurrentEntry* entry = table->slots[index].load(std::memory_order_relaxed);
+            if (!entry) {
+                if (firstFree == table->capacity) firstFree = index;
+                break;
+            }
+            if (entry == &tombstone) {
+                if (firstFree == table->capacity) firstFree = index;
+                continue;
+            }
+            if (entry->hash == hash && entry->key == key) {
+                // Update: publish a fresh entry, never mutate a visible one
+                table->slots[index].store(new ConcurrentEntry{hash, entry->key, value});
+                retire(shard, entry, nullptr);
+                reclaim(shard);
+                return;
+            }
+        }
+
+        if (table->slots[firstFree].load(std::memory_order_relaxed) == nullptr) shard.used++;
+        shard.count++;
+        table->slots[firstFree].store(new ConcurrentEntry{hash, key, value});
+        reclaim(shard);
+    }
+
+    bool search(const char* key, std::string& out) {
+        uint64_t hash = hashKey(key);
+        Shard& shard = shardFor(hash);
+        ReaderSlot* slot = currentReaderSlot();
+        if (!slot) {
+            std::lock_guard<std::mutex> guard(shard.writeLock);
+            return probe(shard, hash, key, out);
+        }
+
+        // Announce before loading anything a writer might retire
+        slot->epoch.store(globalEpoch.load());
+        bool found = probe(shard, hash, key, out);
+        slot->epoch.store(0, std::memory_order_release);
+        return found;
+    }
+
+    bool remove(const char* key) {
+        uint64_t hash = hashKey(key);
+        Shard& shard = shardFor(hash);
+        std::lock_guard<std::mutex> guard(shard.writeLock);
+
+        ConcurrentSlotArray* table = shard.table.load(std::memory_order_relaxed);
+        size_t mask = table->capacity - 1;
+        size_t index = hash & mask;
+        for (size_t probes = 0; probes < table->capacity; probes++, index = (index + 1) & mask) {
+            ConcurrentEntry* entry = table->slots[index].load(std::memory_order_relaxed);
+            if (!entry) return false;
+            if (entry != &tombstone && entry->hash == hash && entry->key == key) {
+                table->slots[index].store(&tombstone);
+                retire(shard, entry, nullptr);
+                shard.count--;
+                reclaim(shard);
+                return true;
+            }
+        }
+        return false;
+    }
+
+    void clear() {
+        for (int i = 0; i < (1 << shardBits); i++) {
+            Shard& shard = shards[i];
+            std::lock_guard<std::mutex> guard(shard.writeLock);
+            ConcurrentSlotArray* table = shard.table.load(std::memory_order_relaxed);
+            shard.table.store(new ConcurrentSlotArray(INITIAL_SHARD_CAPACITY));
+            for (size_t j = 0; j < table->capacity; j++) {
+                ConcurrentEntry* entry = table->slots[j].load(std::memory_order_relaxed);
+                if (entry && entry != &tombstone) retire(shard, entry, nullptr);
+            }
+            retire(shard, nullptr, table);
+            shard.used = 0;
+            shard.count = 0;
+            reclaim(shard, true);
+        }
+    }
+
+    int getCount() {
+        size_t total = 0;
+        for (int i = 0; i < (1 << shardBits); i++) {
+            std::lock_guard<std::mutex> guard(shards[i].writeLock);
+            total += shards[i].count;
+        }
+        return static_cast<int>(total);
+    }
+
+    int getShardCount() { return 1 << shardBits; }
+};
+
+ConcurrentEntry ConcurrentHashTable::tombstone;
+
+// Published atomically so threads racing on the first insert share one table
+static std::atomic<ConcurrentHashTable*> concurrentHashTable{nullptr};
+static std::once_flag concurrentHashTableCreated;
+
+static ConcurrentHashTable* currentConcurrentHashTable() {
+    return concurrentHashTable.load(std::memory_order_acquire);
+}
+
+static ConcurrentHashTable* sharedConcurrentHashTable() {
+    ConcurrentHashTable* table = currentConcurrentHashTable();
+    if (table) return table;
+    std::call_once(concurrentHashTableCreated, [] {
+        ConcurrentHashTable* expected = nullptr;
+        ConcurrentHashTable* created = new ConcurrentHashTable();
+        if (!concurrentHashTable.compare_exchange_strong(expected, created)) delete created;
+    });
+    return currentConcurrentHashTable();
+}
+
+extern "C" {
+    // Replaces the table; must not run while other threads use it
+    EMSCRIPTEN_KEEPALIVE
+    void createConcurrentHashTable(int shardCount) {
+        delete concurrentHashTable.exchange(new ConcurrentHashTable(shardCount));
+    }
+
+    EMSCRIPTEN_KEEPALIVE
+    void concurrentHashTableInsert(const char* key, const char* value) {
+        sharedConcurrentHashTable()->insert(key, value);
+    }
+
+    // Copies the value into out (NUL-terminated, truncated to capacity) and
+    // returns its full length, or -1 if the key is absent.
+    EMSCRIPTEN_KEEPALIVE
+    int concurrentHashTableSearch(const char* key, char* out, int capacity) {
+        ConcurrentHashTable* table = currentConcurrentHashTable();
+        if (!table) return -1;
+        std::string value;
+        if (!table->search(key, value)) return -1;
+        if (out && capacity > 0) {
+            size_t n = std::min(value.size(), static_cast<size_t>(capacity - 1));
+            memcpy(out, value.data(), n);
+            out[n] = '\0';
+        }
+        return static_cast<int>(value.size());
+    }
+
+    EMSCRIPTEN_KEEPALIVE
+    int concurrentHashTableDelete(const char* key) {
+        ConcurrentHashTable* table = currentConcurrentHashTable();
+        if (!table) return 0;
+        return table->remove(key) ? 1 : 0;
+    }
+
+    EMSCRIPTEN_KEEPALIVE
+    void concurrentHashTableClear() {
+        ConcurrentHashTable* table = currentConcurrentHashTable();
+        if (table) table->clear();
+    }
+
+    EMSCRIPTEN_KEEPALIVE
+    int concurrentHashTableGetCount() {
+        ConcurrentHashTable* table = currentConcurrentHashTable();
+        if (!table) return 0;
+        return table->getCount();
+    }
+}
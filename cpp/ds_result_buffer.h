@@ -0,0 +1,31 @@
+#pragma once
+
+// Result-buffer protocol for exports that return a sequence.
+//
+// Every such export comes in two forms:
+//   T* name(..., int* size)                 view into a library-owned buffer,
+//                                           valid until the next call into
+//                                           the same structure; never free it
+//   int nameInto(..., T* out, int capacity) copies up to capacity items into
+//                                           a caller buffer and returns the
+//                                           full count, so a short buffer can
+//                                           be grown and the call retried
+// The library-owned buffers are reused, so repeated calls do not allocate
+// once they have reached their working size.
+
+#include <algorithm>
+#include <vector>
+
+template <typename T>
+T* resultView(std::vector<T>& buffer, int* size) {
+    if (size) *size = buffer.size();
+    return buffer.empty() ? nullptr : buffer.data();
+}
+
+template <typename T>
+int resultInto(const std::vector<T>& buffer, T* out, int capacity) {
+    if (out && capacity > 0) {
+        std::copy_n(buffer.begin(), std::min<size_t>(buffer.size(), capacity), out);
+    }
+    return buffer.size();
+}
@@ -0,0 +1,102 @@
+#pragma once
+
+// Optional operation counters and latency histograms.
+//
+// Build with -DDS_ENABLE_STATS=1 to turn them on. When disabled the stats
+// members and every DS_STAT / DS_STAT_TIMER statement compile away, and the
+// *GetStats exports just report {"enabled":false}.
+
+#include <cstdint>
+#include <string>
+
+#ifndef DS_ENABLE_STATS
+#define DS_ENABLE_STATS 0
+#endif
+
+#if DS_ENABLE_STATS
+
+#include <chrono>
+
+#define DS_STAT(statement) do { statement; } while (0)
+#define DS_STAT_CONCAT_(a, b) a##b
+#define DS_STAT_CONCAT(a, b) DS_STAT_CONCAT_(a, b)
+#define DS_STAT_TIMER(histogram) DSScopedTimer DS_STAT_CONCAT(dsStatTimer, __LINE__)(histogram)
+
+// Bucket i counts samples in [2^(i-1), 2^i); bucket 0 counts zeros.
+struct DSHistogram {
+    static const int BUCKETS = 40;
+    uint64_t buckets[BUCKETS] = {};
+    uint64_t count = 0;
+    uint64_t sum = 0;
+    uint64_t max = 0;
+
+    void record(uint64_t sample) {
+        int bucket = 0;
+        while (bucket < BUCKETS - 1 && (sample >> bucket) != 0) bucket++;
+        buckets[bucket]++;
+        count++;
+        sum += sample;
+        if (sample > max) max = sample;
+    }
+};
+
+// Records the lifetime of the enclosing scope in nanoseconds.
+class DSScopedTimer {
+private:
+    DSHistogram& histogram;
+    std::chrono::steady_clock::time_point start;
+
+public:
+    explicit DSScopedTimer(DSHistogram& target) : histogram(target), start(std::chrono::steady_clock::now()) {}
+
+    ~DSScopedTimer() {
+        auto elapsed = std::chrono::steady_clock::now() - start;
+        histogram.record(std::chrono::duration_cast<std::chrono::nanoseconds>(elapsed).count());
+    }
+};
+
+// Builds one flat JSON object; histograms are emitted as objects holding
+// count/sum/max and the non-empty buckets keyed by their upper bound.
+class DSStatsWriter {
+private:
+    std::string json = "{\"enabled\":true";
+
+public:
+    DSStatsWriter& counter(const char* name, uint64_t value) {
+        json += ",\"";
+        json += name;
+        json += "\":";
+        json += std::to_string(value);
+        return *this;
+    }
+
+    DSStatsWriter& histogram(const char* name, const DSHistogram& h) {
+        json += ",\"";
+        json += name;
+        json += "\":{\"count\":" + std::to_string(h.count) +
+                ",\"sum\":" + std::to_string(h.sum) +
+                ",\"max\":" + std::to_string(h.max) + ",\"buckets\":{";
+        bool first = true;
+        for (int i = 0; i < DSHistogram::BUCKETS; i++) {
+            if (h.buckets[i] == 0) continue;
+            if (!first) json += ",";
+            first = false;
+            json += "\"" + std::to_string(i == 0 ? 0 : (uint64_t(1) << i) - 1) + "\":" + std::to_string(h.buckets[i]);
+        }
+        json += "}}";
+        return *this;
+    }
+
+    std::string finish() { return json + "}"; }
+};
+
+#else
+
+#define DS_STAT(statement) do {} while (0)
+#define DS_STAT_TIMER(histogram) do {} while (0)
+
+#endif
+
+static const char DS_STATS_DISABLED_JSON[] = "{\"enabled\":false}";
+// Reported while a background job owns the structure (see thread_pool.h)
+static const char DS_STATS_BUSY_JSON[] = "{\"busy\":true}";
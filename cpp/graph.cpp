@@ -5,13 +5,58 @@
 #include <stack>
 #include <climits>
 #include <algorithm>
+#include <string>
 #include <emscripten.h>
+#include "ds_stats.h"
+#include "ds_result_buffer.h"
+#include "thread_pool.h"
+
+#if DS_ENABLE_STATS
+struct GraphStats {
+    uint64_t nodesVisited = 0;
+    uint64_t edgesScanned = 0;
+    uint64_t edgesRelaxed = 0;
+    uint64_t heapPushes = 0;
+    uint64_t stalePops = 0;
+    DSHistogram bfsNanos;
+    DSHistogram dfsNanos;
+    DSHistogram dijkstraNanos;
+    DSHistogram primNanos;
+};
+#endif
 
 class Graph {
 private:
     std::set<char> nodes;
     std::map<char, std::vector<char>> edges;
-    std::map<std::string, int> weights;
+    // Keyed by edgeKey(from, to) so lookups build no temporary strings
+    std::map<int, int> weights;
+
+    // Reused across calls so repeated traversals and shortest-path or MST
+    // queries do not allocate once they reach their working size
+    std::vector<char> traversal;
+    std::vector<char> pending;
+    bool visited[256];
+    int distance[256];
+    std::vector<std::pair<int, char>> frontier;
+
+    static int edgeKey(char from, char to) {
+        return ((unsigned char)from << 8) | (unsigned char)to;
+    }
+
+    int weightOf(char from, char to) {
+        auto it = weights.find(edgeKey(from, to));
+        return it != weights.end() ? it->second : 1;
+    }
+
+    const std::vector<char>* neighborsOf(char node) {
+        auto it = edges.find(node);
+        return it != edges.end() ? &it->second : nullptr;
+    }
+
+#if DS_ENABLE_STATS
+    GraphStats stats;
+#endif
 
 public:
     void addNode(char node) {
@@ -30,8 +75,7 @@ public:
     void addEdge(char from, char to, int weight = 1) {
         if (nodes.find(from) != nodes.end() && nodes.find(to) != nodes.end()) {
             edges[from].push_back(to);
-            std::string key = std::string(1, from) + "-" + std::string(1, to);
-            weights[key] = weight;
+            weights[edgeKey(from, to)] = weight;
         }
     }
 
@@ -41,8 +85,7 @@ public:
                 std::remove(edges[from].begin(), edges[from].end(), to),
                 edges[from].end()
             );
-            std::string key = std::string(1, from) + "-" + std::string(1, to);
-            weights.erase(key);
+            weights.erase(edgeKey(from, to));
         }
     }
 
@@ -52,188 +95,337 @@ public:
         weights.clear();
     }
 
-    std::vector<char> bfs(char start) {
-        std::vector<char> result;
-        if (nodes.find(start) == nodes.end()) return result;
+    // The returned vector is reused by the next bfs/dfs call
+    std::vector<char>& bfs(char start) {
+        DS_STAT_TIMER(stats.bfsNanos);
+        traversal.clear();
+        if (nodes.find(start) == nodes.end()) return traversal;
 
-        std::queue<char> q;
-        std::set<char> visited;
-        q.push(start);
-        visited.insert(start);
+        pending.clear();
+        std::fill(std::begin(visited), std::end(visited), false);
+        pending.push_back(start);
+        visited[(unsigned char)start] = true;
 
-        while (!q.empty()) {
-            char current = q.front();
-            q.pop();
-            result.push_back(current);
+        for (size_t head = 0; head < pending.size(); head++) {
+            char current = pending[head];
+            traversal.push_back(current);
+            DS_STAT(stats.nodesVisited++);
 
             for (char neighbor : edges[current]) {
-                if (visited.find(neighbor) == visited.end()) {
-                    visited.insert(neighbor);
-                    q.push(neighbor);
+                DS_STAT(stats.edgesScanned++);
+                if (!visited[(unsigned char)neighbor]) {
+                    visited[(unsigned char)neighbor] = true;
+                    pending.push_back(neighbor);
                 }
             }
         }
-        return result;
+        return traversal;
     }
 
-    std::vector<char> dfs(char start) {
-        std::vector<char> result;
-        if (nodes.find(start) == nodes.end()) return result;
+    std::vector<char>& dfs(char start) {
+        DS_STAT_TIMER(stats.dfsNanos);
+        traversal.clear();
+        if (nodes.find(start) == nodes.end()) return traversal;
 
-        std::stack<char> s;
-        std::set<char> visited;
-        s.push(start);
+        pending.clear();
+        std::fill(std::begin(visited), std::end(visited), false);
+        pending.push_back(start);
 
-        while (!s.empty()) {
-            char current = s.top();
-            s.pop();
+        while (!pending.empty()) {
+            char current = pending.back();
+            pending.pop_back();
 
-            if (visited.find(current) != visited.end()) continue;
-            visited.insert(current);
-            result.push_back(current);
+            if (visited[(unsigned char)current]) continue;
+            visited[(unsigned char)current] = true;
+            traversal.push_back(current);
+            DS_STAT(stats.nodesVisited++);
 
             for (auto it = edges[current].rbegin(); it != edges[current].rend(); ++it) {
-                if (visited.find(*it) == visited.end()) {
-                    s.push(*it);
+                DS_STAT(stats.edgesScanned++);
+                if (!visited[(unsigned char)*it]) {
+                    pending.push_back(*it);
                 }
             }
         }
-        return result;
+        return traversal;
     }
 
-    std::map<char, int> dijkstra(char start) {
-        std::map<char, int> distances;
-        for (char node : nodes) {
-            distances[node] = INT_MAX;
+    // Appends (node, distance) pairs to out in node order; unreachable
+    // nodes report INT_MAX
+    void dijkstra(char start, std::vector<int>& out) {
+        DS_STAT_TIMER(stats.dijkstraNanos);
+        std::greater<std::pair<int, char>> later;
+        std::fill(std::begin(distance), std::end(distance), INT_MAX);
+        frontier.clear();
+        if (nodes.find(start) != nodes.end()) {
+            distance[(unsigned char)start] = 0;
+            frontier.push_back({0, start});
         }
-        distances[start] = 0;
-
-        std::vector<std::pair<int, char>> pq;
-        pq.push_back({0, start});
-        std::make_heap(pq.begin(), pq.end(), std::greater<std::pair<int, char>>());
 
-        while (!pq.empty()) {
-            std::pop_heap(pq.begin(), pq.end(), std::greater<std::pair<int, char>>());
-            int dist = pq.back().first;
-            char current = pq.back().second;
-            pq.pop_back();
+        while (!frontier.empty()) {
+            std::pop_heap(frontier.begin(), frontier.end(), later);
+            int dist = frontier.back().first;
+            char current = frontier.back().second;
+            frontier.pop_back();
 
-            if (dist > distances[current]) continue;
-
-            for (char neighbor : edges[current]) {
-                std::string key = std::string(1, current) + "-" + std::string(1, neighbor);
-                int weight = (weights.find(key) != weights.end()) ? weights[key] : 1;
-                int alt = distances[current] + weight;
-
-                if (alt < distances[neighbor]) {
-                    distances[neighbor] = alt;
-                    pq.push_back({alt, neighbor});
-                    std::push_heap(pq.begin(), pq.end(), std::greater<std::pair<int, char>>());
+            if (dist > distance[(unsigned char)current]) {
+                DS_STAT(stats.stalePops++);
+                continue;
+            }
+            DS_STAT(stats.nodesVisited++);
+
+            const std::vector<char>* neighbors = neighborsOf(current);
+            if (!neighbors) continue;
+            for (char neighbor : *neighbors) {
+                DS_STAT(stats.edgesScanned++);
+                int alt = dist + weightOf(current, neighbor);
+                if (alt < distance[(unsigned char)neighbor]) {
+                    distance[(unsigned char)neighbor] = alt;
+                    DS_STAT(stats.edgesRelaxed++; stats.heapPushes++);
+                    frontier.push_back({alt, neighbor});
+                    std::push_heap(frontier.begin(), frontier.end(), later);
                 }
             }
         }
-        return distances;
+
+        for (char node : nodes) {
+            out.push_back(node);
+            out.push_back(distance[(unsigned char)node]);
+        }
     }
 
-    std::vector<std::string> prim(char start) {
-        std::vector<std::string> mst;
-        std::set<char> inMST;
-        inMST.insert(start);
+    // Appends (from, to, weight) triples to out in the order edges join the
+    // tree. Tree nodes are scanned in node order, so ties go to the
+    // smallest tree node, then to the earliest edge added.
+    void prim(char start, std::vector<int>& out) {
+        DS_STAT_TIMER(stats.primNanos);
+        if (nodes.find(start) == nodes.end()) return;
+        std::fill(std::begin(visited), std::end(visited), false);
+        visited[(unsigned char)start] = true;
 
-        while (inMST.size() < nodes.size()) {
+        for (size_t treeSize = 1; treeSize < nodes.size(); treeSize++) {
             int minWeight = INT_MAX;
-            std::string minEdge = "";
-
-            for (char node : inMST) {
-                for (char neighbor : edges[node]) {
-                    if (inMST.find(neighbor) == inMST.end()) {
-                        std::string key = std::string(1, node) + "-" + std::string(1, neighbor);
-                        int weight = (weights.find(key) != weights.end()) ? weights[key] : 1;
-                        if (weight < minWeight) {
-                            minWeight = weight;
-                            minEdge = key;
-                        }
+            char minFrom = 0;
+            char minTo = 0;
+            bool found = false;
+
+            for (char node : nodes) {
+                if (!visited[(unsigned char)node]) continue;
+                const std::vector<char>* neighbors = neighborsOf(node);
+                if (!neighbors) continue;
+                for (char neighbor : *neighbors) {
+                    DS_STAT(stats.edgesScanned++);
+                    if (visited[(unsigned char)neighbor]) continue;
+                    int weight = weightOf(node, neighbor);
+                    if (weight < minWeight) {
+                        minWeight = weight;
+                        minFrom = node;
+                        minTo = neighbor;
+                        found = true;
                     }
                 }
             }
 
-            if (!minEdge.empty()) {
-                mst.push_back(minEdge);
-                inMST.insert(minEdge[2]);
-            } else {
-                break;
-            }
+            if (!found) break;
+            out.push_back(minFrom);
+            out.push_back(minTo);
+            out.push_back(minWeight);
+            visited[(unsigned char)minTo] = true;
         }
-        return mst;
     }
 
     int getNodeCount() { return nodes.size(); }
+
+#if DS_ENABLE_STATS
+    std::string statsJSON() {
+        return DSStatsWriter()
+            .counter("nodesVisited", stats.nodesVisited)
+            .counter("edgesScanned", stats.edgesScanned)
+            .counter("edgesRelaxed", stats.edgesRelaxed)
+            .counter("heapPushes", stats.heapPushes)
+            .counter("stalePops", stats.stalePops)
+            .histogram("bfsNanos", stats.bfsNanos)
+            .histogram("dfsNanos", stats.dfsNanos)
+            .histogram("dijkstraNanos", stats.dijkstraNanos)
+            .histogram("primNanos", stats.primNanos)
+            .finish();
+    }
+
+    void resetStats() { stats = GraphStats(); }
+#endif
 };
 
 static Graph* graph = nullptr;
+static JobOwnership graphJob;
 
 extern "C" {
     EMSCRIPTEN_KEEPALIVE
     void createGraph() {
+        if (graphJob.busy()) return;
         if (graph) delete graph;
         graph = new Graph();
     }
 
     EMSCRIPTEN_KEEPALIVE
     void graphAddNode(char node) {
+        if (graphJob.busy()) return;
         if (!graph) graph = new Graph();
         graph->addNode(node);
     }
 
     EMSCRIPTEN_KEEPALIVE
     void graphRemoveNode(char node) {
-        if (graph) graph->removeNode(node);
+        if (graph && !graphJob.busy()) graph->removeNode(node);
     }
 
     EMSCRIPTEN_KEEPALIVE
     void graphAddEdge(char from, char to, int weight) {
+        if (graphJob.busy()) return;
         if (!graph) graph = new Graph();
         graph->addEdge(from, to, weight);
     }
 
     EMSCRIPTEN_KEEPALIVE
     void graphRemoveEdge(char from, char to) {
-        if (graph) graph->removeEdge(from, to);
+        if (graph && !graphJob.busy()) graph->removeEdge(from, to);
     }
 
     EMSCRIPTEN_KEEPALIVE
     void graphClear() {
-        if (graph) graph->clear();
+        if (graph && !graphJob.busy()) graph->clear();
     }
 
+    // Traversal results are node labels, one char each; see ds_result_buffer.h
     EMSCRIPTEN_KEEPALIVE
-    int* graphBFS(char start, int* size) {
-        if (!graph) {
+    char* graphBFS(char start, int* size) {
+        if (!graph || graphJob.busy()) {
             *size = 0;
             return nullptr;
         }
-        std::vector<char> result = graph->bfs(start);
-        *size = result.size();
-        int* arr = new int[result.size()];
-        for (size_t i = 0; i < result.size(); i++) {
-            arr[i] = result[i];
-        }
-        return arr;
+        return resultView(graph->bfs(start), size);
+    }
+
+    EMSCRIPTEN_KEEPALIVE
+    int graphBFSInto(char start, char* out, int capacity) {
+        if (!graph || graphJob.busy()) return 0;
+        return resultInto(graph->bfs(start), out, capacity);
     }
 
     EMSCRIPTEN_KEEPALIVE
-    int* graphDFS(char start, int* size) {
-        if (!graph) {
+    char* graphDFS(char start, int* size) {
+        if (!graph || graphJob.busy()) {
             *size = 0;
             return nullptr;
         }
-        std::vector<char> result = graph->dfs(start);
-        *size = result.size();
-        int* arr = new int[result.size()];
-        for (size_t i = 0; i < result.size(); i++) {
-            arr[i] = result[i];
-        }
-        return arr;
+        return resultView(graph->dfs(start), size);
     }
-}
 
+    EMSCRIPTEN_KEEPALIVE
+    int graphDFSInto(char start, char* out, int capacity) {
+        if (!graph || graphJob.busy()) return 0;
+        return resultInto(graph->dfs(start), out, capacity);
+    }
+
+    // Flattened (node, distance) pairs in node order; unreachable nodes
+    // report INT_MAX. size and the return value count ints, not pairs.
+    static std::vector<int> dijkstraResult;
+
+    static void fillDijkstra(char start) {
+        dijkstraResult.clear();
+        if (graph) graph->dijkstra(start, dijkstraResult);
+    }
+
+    // Dijkstra and Prim results share the graph's job ownership: while a
+    // job runs, these report an empty result
+    static std::vector<int> noResult;
+
+    EMSCRIPTEN_KEEPALIVE
+    int* graphDijkstra(char start, int* size) {
+        if (graphJob.busy()) return resultView(noResult, size);
+        fillDijkstra(start);
+        return resultView(dijkstraResult, size);
+    }
+
+    EMSCRIPTEN_KEEPALIVE
+    int graphDijkstraInto(char start, int* out, int capacity) {
+        if (graphJob.busy()) return 0;
+        fillDijkstra(start);
+        return resultInto(dijkstraResult, out, capacity);
+    }
+
+    // Runs dijkstra off the calling thread; once the job finishes, read the
+    // distances with graphDijkstraResult. Returns a job id, or -1 while
+    // another graph job is running.
+    EMSCRIPTEN_KEEPALIVE
+    int graphDijkstraAsync(char start) {
+        if (!graphJob.tryAcquire()) return -1;
+        return jobSubmit([start] {
+            fillDijkstra(start);
+            graphJob.release();
+        });
+    }
+
+    EMSCRIPTEN_KEEPALIVE
+    int* graphDijkstraResult(int* size) {
+        if (graphJob.busy()) return resultView(noResult, size);
+        return resultView(dijkstraResult, size);
+    }
+
+    // Flattened (from, to, weight) triples in the order edges joined the
+    // tree. size and the return value count ints, not triples.
+    static std::vector<int> primResult;
+
+    static void fillPrim(char start) {
+        primResult.clear();
+        if (graph) graph->prim(start, primResult);
+    }
+
+    EMSCRIPTEN_KEEPALIVE
+    int* graphPrim(char start, int* size) {
+        if (graphJob.busy()) return resultView(noResult, size);
+        fillPrim(start);
+        return resultView(primResult, size);
+    }
+
+    EMSCRIPTEN_KEEPALIVE
+    int graphPrimInto(char start, int* out, int capacity) {
+        if (graphJob.busy()) return 0;
+        fillPrim(start);
+        return resultInto(primResult, out, capacity);
+    }
+
+    EMSCRIPTEN_KEEPALIVE
+    int graphPrimAsync(char start) {
+        if (!graphJob.tryAcquire()) return -1;
+        return jobSubmit([start] {
+            fillPrim(start);
+            graphJob.release();
+        });
+    }
+
+    EMSCRIPTEN_KEEPALIVE
+    int* graphPrimResult(int* size) {
+        if (graphJob.busy()) return resultView(noResult, size);
+        return resultView(primResult, size);
+    }
+
+    // Returned string stays valid until the next graphGetStats call
+    EMSCRIPTEN_KEEPALIVE
+    const char* graphGetStats() {
+#if DS_ENABLE_STATS
+        if (graphJob.busy()) return DS_STATS_BUSY_JSON;
+        static std::string json;
+        json = graph ? graph->statsJSON() : DSStatsWriter().finish();
+        return json.c_str();
+#else
+        return DS_STATS_DISABLED_JSON;
+#endif
+    }
+
+    EMSCRIPTEN_KEEPALIVE
+    void graphResetStats() {
+#if DS_ENABLE_STATS
+        if (graph && !graphJob.busy()) graph->resetStats();
+#endif
+    }
+}
@@ -1,28 +1,309 @@
 #include <vector>
+#include <algorithm>
+#include <climits>
 #include <list>
 #include <string>
+#include <cstring>
+#include <cstdint>
+#include <cstdio>
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
 #include <emscripten.h>
+#include "ds_stats.h"
+#include "thread_pool.h"
 
 struct KeyValue {
     char* key;
     char* value;
 };
 
+// On-disk snapshot layout, all offsets relative to the start of the file:
+//   header | bucketStart[size + 1] | entries[entryCount] | string heap
+// Bucket i owns entries [bucketStart[i], bucketStart[i + 1]); a linear
+// probing table stores at most one entry per bucket. Entries hold heap
+// offsets of NUL-terminated strings, so the file can be mapped anywhere.
+struct HashTableFileHeader {
+    char magic[4];
+    uint32_t version;
+    uint32_t size;
+    uint32_t useChaining;
+    uint64_t entryCount;
+    uint64_t heapLength;
+};
+
+struct HashTableFileEntry {
+    uint64_t key;
+    uint64_t value;
+};
+
+#if DS_ENABLE_STATS
+struct HashTableStats {
+    uint64_t inserts = 0;
+    uint64_t searches = 0;
+    uint64_t hits = 0;
+    uint64_t deletes = 0;
+    // Keys compared per operation (chain walk or probe sequence)
+    DSHistogram searchProbes;
+    DSHistogram insertProbes;
+    // Bucket length right after a chaining insert
+    DSHistogram chainLength;
+    DSHistogram searchNanos;
+    DSHistogram insertNanos;
+    DSHistogram batchNanos;
+    uint64_t currentProbes = 0;
+};
+#endif
+
+static const char HASH_TABLE_FILE_MAGIC[4] = {'D', 'S', 'H', 'T'};
+static const uint32_t HASH_TABLE_FILE_VERSION = 1;
+
 class HashTable {
 private:
+    // Keys per pipeline stage; small enough that what one stage prefetches
+    // is still cached when the next stage reaches it.
+    static constexpr int BATCH_CHUNK = 32;
+
     int size;
     bool useChaining;
     std::vector<std::list<KeyValue>> chainingTable;
     std::vector<KeyValue*> linearTable;
 
+    // The snapshot mapping stays alive until the table is destroyed, even
+    // after copy-on-write, so pointers already handed out remain readable.
+    // mappedBuckets is set only while lookups are served from it.
+    void* mapping = nullptr;
+    size_t mappingLength = 0;
+    bool copyOnWrite = false;
+    const uint64_t* mappedBuckets = nullptr;
+    const HashTableFileEntry* mappedEntries = nullptr;
+    const char* mappedHeap = nullptr;
+
+#if DS_ENABLE_STATS
+    HashTableStats stats;
+#endif
+
     int hash(const char* key) {
+        return hash(key, strlen(key));
+    }
+
+    int hash(const char* key, int length) {
         int hash = 0;
-        for (int i = 0; key[i] != '\0'; i++) {
+        for (int i = 0; i < length; i++) {
             hash = (hash * 31 + key[i]) % size;
         }
         return hash;
     }
 
+    // key need not be NUL-terminated; stored is never read past its NUL
+    static bool keyEquals(const char* stored, const char* key, int length) {
+        return strnlen(stored, length + 1) == (size_t)length && memcmp(stored, key, length) == 0;
+    }
+
+    static char* copyString(const char* str, int length) {
+        char* copy = new char[length + 1];
+        memcpy(copy, str, length);
+        copy[length] = '\0';
+        return copy;
+    }
+
+    // Prefetch hints for the batch pipeline. WebAssembly has no prefetch
+    // instruction, so __builtin_prefetch compiles to nothing there and only
+    // native builds overlap the loads; prefetchEntry still reads the bucket.
+    void prefetchBucket(int index) {
+        if (mappedBuckets) {
+            __builtin_prefetch(&mappedBuckets[index]);
+        } else if (useChaining) {
+            __builtin_prefetch(&chainingTable[index]);
+        } else {
+            __builtin_prefetch(&linearTable[index]);
+        }
+    }
+
+    void prefetchEntry(int index) {
+        if (mappedBuckets) {
+            __builtin_prefetch(&mappedEntries[mappedBuckets[index]]);
+        } else if (useChaining) {
+            if (!chainingTable[index].empty()) __builtin_prefetch(chainingTable[index].front().key);
+        } else if (linearTable[index]) {
+            __builtin_prefetch(linearTable[index]->key);
+        }
+    }
+
+    // Runs a batch as a three-stage pipeline over chunks of BATCH_CHUNK
+    // keys: chunk c is hashed and its buckets prefetched while chunk c - 1
+    // has its entries prefetched and chunk c - 2 is compared, so each stage
+    // only touches memory requested a whole chunk earlier. keyAt(i, length)
+    // returns key i; visit(i, index, key, length) runs in batch order.
+    template <typename KeyAt, typename Visit>
+    void runPipelined(int count, KeyAt keyAt, Visit visit) {
+        int indices[3][BATCH_CHUNK];
+        int chunks = (count + BATCH_CHUNK - 1) / BATCH_CHUNK;
+        auto chunkLength = [count](int chunk) {
+            return std::min(BATCH_CHUNK, count - chunk * BATCH_CHUNK);
+        };
+        for (int c = 0; c < chunks + 2; c++) {
+            if (c < chunks) {
+                int* stage = indices[c % 3];
+                for (int i = 0; i < chunkLength(c); i++) {
+                    int length;
+                    const char* key = keyAt(c * BATCH_CHUNK + i, length);
+                    stage[i] = hash(key, length);
+                    prefetchBucket(stage[i]);
+                }
+            }
+            if (c >= 1 && c <= chunks) {
+                int* stage = indices[(c - 1) % 3];
+                for (int i = 0; i < chunkLength(c - 1); i++) prefetchEntry(stage[i]);
+            }
+            if (c >= 2) {
+                int* stage = indices[(c - 2) % 3];
+                for (int i = 0; i < chunkLength(c - 2); i++) {
+                    int item = (c - 2) * BATCH_CHUNK + i;
+                    int length;
+                    const char* key = keyAt(item, length);
+                    visit(item, stage[i], key, length);
+                }
+            }
+        }
+    }
+
+    static bool validateSnapshot(const HashTableFileHeader* header, size_t length) {
+        if (length < sizeof(HashTableFileHeader)) return false;
+        if (memcmp(header->magic, HASH_TABLE_FILE_MAGIC, 4) != 0) return false;
+        if (header->version != HASH_TABLE_FILE_VERSION) return false;
+        if (header->size == 0 || header->size > INT_MAX) return false;
+        // Check each section against the bytes left so no sum can wrap
+        uint64_t rest = length - sizeof(HashTableFileHeader);
+        if (uint64_t(header->size) + 1 > rest / sizeof(uint64_t)) return false;
+        rest -= (uint64_t(header->size) + 1) * sizeof(uint64_t);
+        if (header->entryCount > rest / sizeof(HashTableFileEntry)) return false;
+        rest -= header->entryCount * sizeof(HashTableFileEntry);
+        if (header->heapLength != rest) return false;
+
+        const uint64_t* buckets = reinterpret_cast<const uint64_t*>(header + 1);
+        const HashTableFileEntry* entries = reinterpret_cast<const HashTableFileEntry*>(buckets + header->size + 1);
+        const char* heap = reinterpret_cast<const char*>(entries + header->entryCount);
+        if (buckets[0] != 0 || buckets[header->size] != header->entryCount) return false;
+        for (uint32_t i = 0; i < header->size; i++) {
+            if (buckets[i] > buckets[i + 1]) return false;
+            if (!header->useChaining && buckets[i + 1] - buckets[i] > 1) return false;
+        }
+        // Every string must end inside the heap; a trailing NUL guarantees it
+        if (header->entryCount > 0 && (header->heapLength == 0 || heap[header->heapLength - 1] != '\0')) return false;
+        for (uint64_t i = 0; i < header->entryCount; i++) {
+            if (entries[i].key >= header->heapLength || entries[i].value >= header->heapLength) return false;
+        }
+        return true;
+    }
+
+    bool writeSnapshot(FILE* file) {
+        std::vector<uint64_t> buckets(size + 1, 0);
+        std::vector<HashTableFileEntry> entries;
+        std::vector<char> heap;
+        auto append = [&heap](const char* str) {
+            uint64_t offset = heap.size();
+            heap.insert(heap.end(), str, str + strlen(str) + 1);
+            return offset;
+        };
+        for (int i = 0; i < size; i++) {
+            if (useChaining) {
+                for (const auto& item : chainingTable[i]) {
+                    entries.push_back({append(item.key), append(item.value)});
+                }
+            } else if (linearTable[i]) {
+                entries.push_back({append(linearTable[i]->key), append(linearTable[i]->value)});
+            }
+            buckets[i + 1] = entries.size();
+        }
+
+        HashTableFileHeader header;
+        memcpy(header.magic, HASH_TABLE_FILE_MAGIC, 4);
+        header.version = HASH_TABLE_FILE_VERSION;
+        header.size = size;
+        header.useChaining = useChaining ? 1 : 0;
+        header.entryCount = entries.size();
+        header.heapLength = heap.size();
+        auto write = [file](const void* data, size_t bytes) {
+            return bytes == 0 || fwrite(data, 1, bytes, file) == bytes;
+        };
+        return write(&header, sizeof(header)) &&
+               write(buckets.data(), buckets.size() * sizeof(uint64_t)) &&
+               write(entries.data(), entries.size() * sizeof(HashTableFileEntry)) &&
+               write(heap.data(), heap.size());
+    }
+
+    const char* searchMapped(int index, const char* key, int keyLength) {
+        if (useChaining) {
+            for (uint64_t e = mappedBuckets[index]; e < mappedBuckets[index + 1]; e++) {
+                DS_STAT(stats.currentProbes++);
+                if (keyEquals(mappedHeap + mappedEntries[e].key, key, keyLength)) {
+                    DS_STAT(stats.hits++);
+                    return mappedHeap + mappedEntries[e].value;
+                }
+            }
+        } else {
+            int currentIndex = index;
+            int attempts = 0;
+            while (attempts < size) {
+                uint64_t e = mappedBuckets[currentIndex];
+                if (e == mappedBuckets[currentIndex + 1]) {
+                    return nullptr;
+                }
+                DS_STAT(stats.currentProbes++);
+                if (keyEquals(mappedHeap + mappedEntries[e].key, key, keyLength)) {
+                    DS_STAT(stats.hits++);
+                    return mappedHeap + mappedEntries[e].value;
+                }
+                currentIndex = (currentIndex + 1) % size;
+                attempts++;
+            }
+        }
+        return nullptr;
+    }
+
+#if DS_ENABLE_STATS
+    void recordProbes(DSHistogram& histogram) {
+        histogram.record(stats.currentProbes);
+        stats.currentProbes = 0;
+    }
+#endif
+
+    void stopServingMapped() {
+        mappedBuckets = nullptr;
+        mappedEntries = nullptr;
+        mappedHeap = nullptr;
+    }
+
+    // Called before every mutation. A mapped table is copied onto the heap
+    // (copy-on-write) or, if opened read-only, the mutation is refused.
+    bool ensureWritable() {
+        if (!mappedBuckets) return true;
+        if (!copyOnWrite) return false;
+        if (useChaining) {
+            chainingTable.resize(size);
+        } else {
+            linearTable.resize(size, nullptr);
+        }
+        for (int i = 0; i < size; i++) {
+            for (uint64_t e = mappedBuckets[i]; e < mappedBuckets[i + 1]; e++) {
+                const char* key = mappedHeap + mappedEntries[e].key;
+                const char* value = mappedHeap + mappedEntries[e].value;
+                KeyValue kv;
+                kv.key = copyString(key, strlen(key));
+                kv.value = copyString(value, strlen(value));
+                if (useChaining) {
+                    chainingTable[i].push_back(kv);
+                } else {
+                    linearTable[i] = new KeyValue(kv);
+                }
+            }
+        }
+        stopServingMapped();
+        return true;
+    }
+
 public:
     HashTable(int tableSize = 11, bool chaining = true) : size(tableSize), useChaining(chaining) {
         if (useChaining) {
@@ -32,42 +313,100 @@ public:
         }
     }
 
+    ~HashTable() {
+        if (!mappedBuckets) clear();
+        if (mapping) munmap(mapping, mappingLength);
+    }
+
+    HashTable(const HashTable&) = delete;
+    HashTable& operator=(const HashTable&) = delete;
+
+    // Maps a snapshot written by save() and serves lookups straight from it.
+    // With copyOnWrite the first mutation copies the contents onto the heap;
+    // without it the table stays read-only. Returns nullptr on a bad file.
+    static HashTable* open(const char* path, bool copyOnWrite) {
+        int fd = ::open(path, O_RDONLY);
+        if (fd < 0) return nullptr;
+        struct stat st;
+        if (fstat(fd, &st) != 0 || st.st_size < (off_t)sizeof(HashTableFileHeader)) {
+            close(fd);
+            return nullptr;
+        }
+        size_t length = st.st_size;
+        void* mapping = mmap(nullptr, length, PROT_READ, MAP_PRIVATE, fd, 0);
+        close(fd);
+        if (mapping == MAP_FAILED) return nullptr;
+
+        const HashTableFileHeader* header = static_cast<const HashTableFileHeader*>(mapping);
+        if (!validateSnapshot(header, length)) {
+            munmap(mapping, length);
+            return nullptr;
+        }
+
+        HashTable* table = new HashTable(0, header->useChaining != 0);
+        table->size = header->size;
+        table->mapping = mapping;
+        table->mappingLength = length;
+        table->copyOnWrite = copyOnWrite;
+        table->mappedBuckets = reinterpret_cast<const uint64_t*>(header + 1);
+        table->mappedEntries = reinterpret_cast<const HashTableFileEntry*>(table->mappedBuckets + header->size + 1);
+        table->mappedHeap = reinterpret_cast<const char*>(table->mappedEntries + header->entryCount);
+        return table;
+    }
+
+    // Writes beside path and renames over it. Truncating in place would
+    // shrink the file under a live mapping of it, this table's included.
+    bool save(const char* path) {
+        std::string temp = std::string(path) + ".tmp";
+        FILE* file = fopen(temp.c_str(), "wb");
+        if (!file) return false;
+        bool ok = mappedBuckets ? fwrite(mapping, 1, mappingLength, file) == mappingLength : writeSnapshot(file);
+        ok = fclose(file) == 0 && ok;
+        if (ok && ::rename(temp.c_str(), path) == 0) return true;
+        unlink(temp.c_str());
+        return false;
+    }
+
     void insert(const char* key, const char* value) {
-        int index = hash(key);
-        
+        DS_STAT_TIMER(stats.insertNanos);
+        int keyLength = strlen(key);
+        insertAt(hash(key, keyLength), key, keyLength, value, strlen(value));
+        DS_STAT(recordProbes(stats.insertProbes));
+    }
+
+    void insertAt(int index, const char* key, int keyLength, const char* value, int valueLength) {
+        if (!ensureWritable()) return;
+        DS_STAT(stats.inserts++);
         if (useChaining) {
             // Check if key exists
             for (auto& item : chainingTable[index]) {
-                if (std::string(item.key) == std::string(key)) {
+                DS_STAT(stats.currentProbes++);
+                if (keyEquals(item.key, key, keyLength)) {
                     delete[] item.value;
-                    item.value = new char[strlen(value) + 1];
-                    strcpy(item.value, value);
+                    item.value = copyString(value, valueLength);
                     return;
                 }
             }
             // Insert new
             KeyValue kv;
-            kv.key = new char[strlen(key) + 1];
-            kv.value = new char[strlen(value) + 1];
-            strcpy(kv.key, key);
-            strcpy(kv.value, value);
+            kv.key = copyString(key, keyLength);
+            kv.value = copyString(value, valueLength);
             chainingTable[index].push_back(kv);
+            DS_STAT(stats.chainLength.record(chainingTable[index].size()));
         } else {
             // Linear probing
             int currentIndex = index;
             int attempts = 0;
             while (attempts < size) {
+                DS_STAT(stats.currentProbes++);
                 if (linearTable[currentIndex] == nullptr) {
                     linearTable[currentIndex] = new KeyValue();
-                    linearTable[currentIndex]->key = new char[strlen(key) + 1];
-                    linearTable[currentIndex]->value = new char[strlen(value) + 1];
-                    strcpy(linearTable[currentIndex]->key, key);
-                    strcpy(linearTable[currentIndex]->value, value);
+                    linearTable[currentIndex]->key = copyString(key, keyLength);
+                    linearTable[currentIndex]->value = copyString(value, valueLength);
                     return;
-                } else if (std::string(linearTable[currentIndex]->key) == std::string(key)) {
+                } else if (keyEquals(linearTable[currentIndex]->key, key, keyLength)) {
                     delete[] linearTable[currentIndex]->value;
-                    linearTable[currentIndex]->value = new char[strlen(value) + 1];
-                    strcpy(linearTable[currentIndex]->value, value);
+                    linearTable[currentIndex]->value = copyString(value, valueLength);
                     return;
                 }
                 currentIndex = (currentIndex + 1) % size;
@@ -77,11 +416,21 @@ public:
     }
 
     const char* search(const char* key) {
-        int index = hash(key);
-        
+        DS_STAT_TIMER(stats.searchNanos);
+        int keyLength = strlen(key);
+        const char* value = searchAt(hash(key, keyLength), key, keyLength);
+        DS_STAT(recordProbes(stats.searchProbes));
+        return value;
+    }
+
+    const char* searchAt(int index, const char* key, int keyLength) {
+        DS_STAT(stats.searches++);
+        if (mappedBuckets) return searchMapped(index, key, keyLength);
         if (useChaining) {
             for (const auto& item : chainingTable[index]) {
-                if (std::string(item.key) == std::string(key)) {
+                DS_STAT(stats.currentProbes++);
+                if (keyEquals(item.key, key, keyLength)) {
+                    DS_STAT(stats.hits++);
                     return item.value;
                 }
             }
@@ -92,7 +441,9 @@ public:
                 if (linearTable[currentIndex] == nullptr) {
                     return nullptr;
                 }
-                if (std::string(linearTable[currentIndex]->key) == std::string(key)) {
+                DS_STAT(stats.currentProbes++);
+                if (keyEquals(linearTable[currentIndex]->key, key, keyLength)) {
+                    DS_STAT(stats.hits++);
                     return linearTable[currentIndex]->value;
                 }
                 currentIndex = (currentIndex + 1) % size;
@@ -102,7 +453,45 @@ public:
         return nullptr;
     }
 
+    // Keys are packed back to back in keys; key i spans
+    // [offsets[i], offsets[i + 1]). Fills results with value pointers
+    // (nullptr when absent) and returns the number of hits.
+    int searchBatch(const int* offsets, const char* keys, int count, const char** results) {
+        DS_STAT_TIMER(stats.batchNanos);
+        int found = 0;
+        auto keyAt = [offsets, keys](int i, int& length) {
+            length = offsets[i + 1] - offsets[i];
+            return keys + offsets[i];
+        };
+        runPipelined(count, keyAt, [&](int i, int index, const char* key, int length) {
+            results[i] = searchAt(index, key, length);
+            DS_STAT(recordProbes(stats.searchProbes));
+            if (results[i]) found++;
+        });
+        return found;
+    }
+
+    // Keys containing a NUL byte cannot be stored as C strings and are skipped
+    void insertBatch(const int* keyOffsets, const char* keys,
+                     const int* valueOffsets, const char* values, int count) {
+        DS_STAT_TIMER(stats.batchNanos);
+        if (!ensureWritable()) return;
+        auto keyAt = [keyOffsets, keys](int i, int& length) {
+            length = keyOffsets[i + 1] - keyOffsets[i];
+            return keys + keyOffsets[i];
+        };
+        // Inserted in order so later duplicates overwrite earlier ones
+        runPipelined(count, keyAt, [&](int i, int index, const char* key, int length) {
+            if (memchr(key, '\0', length)) return;
+            const int* value = valueOffsets + i;
+            insertAt(index, key, length, values + value[0], value[1] - value[0]);
+            DS_STAT(recordProbes(stats.insertProbes));
+        });
+    }
+
     bool remove(const char* key) {
+        if (!ensureWritable()) return false;
+        DS_STAT(stats.deletes++);
         int index = hash(key);
         
         if (useChaining) {
@@ -136,6 +525,7 @@ public:
     }
 
     void clear() {
+        if (!ensureWritable()) return;
         if (useChaining) {
             for (auto& bucket : chainingTable) {
                 for (auto& item : bucket) {
@@ -156,40 +546,173 @@ public:
         }
     }
 
+    // Moves every entry into newSize buckets. Keys are hashed in parallel;
+    // placement stays serial because entries collide on shared buckets.
+    void rehash(int newSize, ThreadPool& pool) {
+        if (newSize < 1 || !ensureWritable()) return;
+        const int grain = 256;
+
+        if (useChaining) {
+            std::vector<KeyValue> entries;
+            for (auto& bucket : chainingTable) {
+                entries.insert(entries.end(), bucket.begin(), bucket.end());
+            }
+            size = newSize;
+            std::vector<int> indices(entries.size());
+            pool.parallelFor(0, entries.size(), grain, [&](int i) { indices[i] = hash(entries[i].key); });
+            chainingTable.assign(size, std::list<KeyValue>());
+            for (size_t i = 0; i < entries.size(); i++) {
+                chainingTable[indices[i]].push_back(entries[i]);
+            }
+        } else {
+            std::vector<KeyValue*> entries;
+            for (KeyValue* item : linearTable) {
+                if (item) entries.push_back(item);
+            }
+            // Linear probing cannot hold more entries than slots
+            if ((int)entries.size() > newSize) return;
+            size = newSize;
+            std::vector<int> indices(entries.size());
+            pool.parallelFor(0, entries.size(), grain, [&](int i) { indices[i] = hash(entries[i]->key); });
+            linearTable.assign(size, nullptr);
+            for (size_t i = 0; i < entries.size(); i++) {
+                int currentIndex = indices[i];
+                while (linearTable[currentIndex]) currentIndex = (currentIndex + 1) % size;
+                linearTable[currentIndex] = entries[i];
+            }
+        }
+    }
+
     int getSize() { return size; }
     bool isChaining() { return useChaining; }
+    bool isMapped() { return mappedBuckets != nullptr; }
+
+#if DS_ENABLE_STATS
+    std::string statsJSON() {
+        return DSStatsWriter()
+            .counter("inserts", stats.inserts)
+            .counter("searches", stats.searches)
+            .counter("hits", stats.hits)
+            .counter("deletes", stats.deletes)
+            .histogram("searchProbes", stats.searchProbes)
+            .histogram("insertProbes", stats.insertProbes)
+            .histogram("chainLength", stats.chainLength)
+            .histogram("searchNanos", stats.searchNanos)
+            .histogram("insertNanos", stats.insertNanos)
+            .histogram("batchNanos", stats.batchNanos)
+            .finish();
+    }
+
+    void resetStats() { stats = HashTableStats(); }
+#endif
 };
 
 static HashTable* hashTable = nullptr;
+static JobOwnership hashTableJob;
 
 extern "C" {
     EMSCRIPTEN_KEEPALIVE
     void createHashTable(int size, int useChaining) {
+        if (hashTableJob.busy()) return;
         if (hashTable) delete hashTable;
         hashTable = new HashTable(size, useChaining == 1);
     }
 
     EMSCRIPTEN_KEEPALIVE
     void hashTableInsert(const char* key, const char* value) {
+        if (hashTableJob.busy()) return;
         if (!hashTable) hashTable = new HashTable(11, true);
         hashTable->insert(key, value);
     }
 
+    // The returned value stays valid until that key is updated or deleted,
+    // or the table is cleared or replaced. Values served from a mapped
+    // snapshot stay valid until the table is replaced, even after a
+    // copy-on-write mutation.
     EMSCRIPTEN_KEEPALIVE
     const char* hashTableSearch(const char* key) {
-        if (!hashTable) return nullptr;
+        if (!hashTable || hashTableJob.busy()) return nullptr;
         return hashTable->search(key);
     }
 
+    // Fills results with value pointers, which follow the same lifetime
+    // rules as hashTableSearch.
+    EMSCRIPTEN_KEEPALIVE
+    int hashTableSearchBatch(const int* offsets, const char* keys, int count, const char** results) {
+        if (!hashTable || hashTableJob.busy()) {
+            for (int i = 0; i < count; i++) results[i] = nullptr;
+            return 0;
+        }
+        return hashTable->searchBatch(offsets, keys, count, results);
+    }
+
+    EMSCRIPTEN_KEEPALIVE
+    void hashTableInsertBatch(const int* keyOffsets, const char* keys,
+                              const int* valueOffsets, const char* values, int count) {
+        if (hashTableJob.busy()) return;
+        if (!hashTable) hashTable = new HashTable(11, true);
+        hashTable->insertBatch(keyOffsets, keys, valueOffsets, values, count);
+    }
+
     EMSCRIPTEN_KEEPALIVE
     int hashTableDelete(const char* key) {
-        if (!hashTable) return 0;
+        if (!hashTable || hashTableJob.busy()) return 0;
         return hashTable->remove(key) ? 1 : 0;
     }
 
+    // Rehashes into newSize buckets on the thread pool. Returns a job id, or
+    // -1 while an earlier rehash is still running.
+    EMSCRIPTEN_KEEPALIVE
+    int hashTableRehashAsync(int newSize) {
+        if (!hashTableJob.tryAcquire()) return -1;
+        if (!hashTable) hashTable = new HashTable(11, true);
+        HashTable* target = hashTable;
+        return jobSubmit([target, newSize] {
+            target->rehash(newSize, sharedThreadPool());
+            hashTableJob.release();
+        });
+    }
+
+    EMSCRIPTEN_KEEPALIVE
+    int hashTableSave(const char* path) {
+        if (!hashTable || hashTableJob.busy()) return 0;
+        return hashTable->save(path) ? 1 : 0;
+    }
+
+    // Replaces the current table with a mapped snapshot; on failure the
+    // current table is kept and 0 is returned.
+    EMSCRIPTEN_KEEPALIVE
+    int hashTableOpen(const char* path, int copyOnWrite) {
+        if (hashTableJob.busy()) return 0;
+        HashTable* opened = HashTable::open(path, copyOnWrite == 1);
+        if (!opened) return 0;
+        if (hashTable) delete hashTable;
+        hashTable = opened;
+        return 1;
+    }
+
     EMSCRIPTEN_KEEPALIVE
     void hashTableClear() {
-        if (hashTable) hashTable->clear();
+        if (hashTable && !hashTableJob.busy()) hashTable->clear();
+    }
+
+    // Returned string stays valid until the next hashTableGetStats call
+    EMSCRIPTEN_KEEPALIVE
+    const char* hashTableGetStats() {
+#if DS_ENABLE_STATS
+        if (hashTableJob.busy()) return DS_STATS_BUSY_JSON;
+        static std::string json;
+        json = hashTable ? hashTable->statsJSON() : DSStatsWriter().finish();
+        return json.c_str();
+#else
+        return DS_STATS_DISABLED_JSON;
+#endif
     }
-}
 
+    EMSCRIPTEN_KEEPALIVE
+    void hashTableResetStats() {
+#if DS_ENABLE_STATS
+        if (hashTable && !hashTableJob.busy()) hashTable->resetStats();
+#endif
+    }
+}
@@ -1,12 +1,30 @@
 #include <vector>
 #include <algorithm>
+#include <climits>
 #include <string>
 #include <emscripten.h>
+#include "ds_stats.h"
+#include "ds_result_buffer.h"
+#include "thread_pool.h"
+
+#if DS_ENABLE_STATS
+struct HeapStats {
+    uint64_t inserts = 0;
+    uint64_t deletes = 0;
+    uint64_t swapsUp = 0;
+    uint64_t swapsDown = 0;
+    DSHistogram insertNanos;
+    DSHistogram deleteNanos;
+};
+#endif
 
 class BinaryHeap {
 private:
     std::vector<int> heap;
     bool isMinHeap;
+#if DS_ENABLE_STATS
+    HeapStats stats;
+#endif
 
     int parent(int i) { return (i - 1) / 2; }
     int left(int i) { return 2 * i + 1; }
@@ -17,6 +35,7 @@ private:
             int p = parent(index);
             if ((isMinHeap && heap[index] < heap[p]) || (!isMinHeap && heap[index] > heap[p])) {
                 std::swap(heap[index], heap[p]);
+                DS_STAT(stats.swapsUp++);
                 index = p;
             } else {
                 break;
@@ -41,6 +60,7 @@ private:
 
             if (smallest != index) {
                 std::swap(heap[index], heap[smallest]);
+                DS_STAT(stats.swapsDown++);
                 index = smallest;
             } else {
                 break;
@@ -52,12 +72,16 @@ public:
     BinaryHeap(bool minHeap = true) : isMinHeap(minHeap) {}
 
     void insert(int value) {
+        DS_STAT_TIMER(stats.insertNanos);
+        DS_STAT(stats.inserts++);
         heap.push_back(value);
         heapifyUp(heap.size() - 1);
     }
 
     int deleteRoot() {
         if (heap.empty()) return -1;
+        DS_STAT_TIMER(stats.deleteNanos);
+        DS_STAT(stats.deletes++);
         int root = heap[0];
         heap[0] = heap.back();
         heap.pop_back();
@@ -67,60 +91,135 @@ public:
         return root;
     }
 
+    // Floyd's bottom-up build. Nodes on the same level root disjoint
+    // subtrees, so each level's sift-downs run in parallel.
+    void build(std::vector<int> values, ThreadPool& pool) {
+        heap = std::move(values);
+        if (heap.size() < 2) return;
+        // Stats counters are plain integers, so keep the build serial then
+        const int grain = DS_ENABLE_STATS ? INT_MAX : 1024;
+        int last = parent(heap.size() - 1);
+        // Start at the deepest level that still has children
+        int levelStart = 0;
+        while (2 * levelStart + 1 <= last) levelStart = 2 * levelStart + 1;
+        while (true) {
+            int levelEnd = std::min(2 * levelStart + 1, last + 1);
+            pool.parallelFor(levelStart, levelEnd, grain, [this](int i) { heapifyDown(i); });
+            if (levelStart == 0) break;
+            levelStart = parent(levelStart);
+        }
+    }
+
     void clear() {
         heap.clear();
     }
 
-    int* getArray() {
-        if (heap.empty()) return nullptr;
-        int* arr = new int[heap.size()];
-        for (size_t i = 0; i < heap.size(); i++) {
-            arr[i] = heap[i];
-        }
-        return arr;
+    // The heap's own storage doubles as the result buffer
+    std::vector<int>& getArray() {
+        return heap;
     }
 
     int getSize() {
         return heap.size();
     }
+
+#if DS_ENABLE_STATS
+    std::string statsJSON() {
+        return DSStatsWriter()
+            .counter("inserts", stats.inserts)
+            .counter("deletes", stats.deletes)
+            .counter("swapsUp", stats.swapsUp)
+            .counter("swapsDown", stats.swapsDown)
+            .histogram("insertNanos", stats.insertNanos)
+            .histogram("deleteNanos", stats.deleteNanos)
+            .finish();
+    }
+
+    void resetStats() { stats = HeapStats(); }
+#endif
 };
 
 static BinaryHeap* heap = nullptr;
+static JobOwnership heapJob;
 
 extern "C" {
     EMSCRIPTEN_KEEPALIVE
     void createHeap(int isMin) {
+        if (heapJob.busy()) return;
         if (heap) delete heap;
         heap = new BinaryHeap(isMin == 1);
     }
 
     EMSCRIPTEN_KEEPALIVE
     void heapInsert(int value) {
+        if (heapJob.busy()) return;
         if (!heap) heap = new BinaryHeap(true);
         heap->insert(value);
     }
 
     EMSCRIPTEN_KEEPALIVE
     int heapDelete() {
-        if (!heap) return -1;
+        if (!heap || heapJob.busy()) return -1;
         return heap->deleteRoot();
     }
 
+    // Replaces the heap contents with values on the thread pool; values is
+    // copied before returning. Returns a job id, or -1 while an earlier
+    // build is still running (see thread_pool.h).
+    EMSCRIPTEN_KEEPALIVE
+    int heapBuildAsync(const int* values, int count) {
+        if (!heapJob.tryAcquire()) return -1;
+        if (!heap) heap = new BinaryHeap(true);
+        BinaryHeap* target = heap;
+        std::vector<int> copy(values, values + std::max(count, 0));
+        return jobSubmit([target, copy = std::move(copy)]() mutable {
+            target->build(std::move(copy), sharedThreadPool());
+            heapJob.release();
+        });
+    }
+
     EMSCRIPTEN_KEEPALIVE
     void heapClear() {
-        if (heap) heap->clear();
+        if (heap && !heapJob.busy()) heap->clear();
     }
 
+    // View of the heap array (length heapGetSize()), valid until the next
+    // heap call; see ds_result_buffer.h
     EMSCRIPTEN_KEEPALIVE
     int* heapGetArray() {
-        if (!heap) return nullptr;
-        return heap->getArray();
+        if (!heap || heapJob.busy()) return nullptr;
+        return resultView(heap->getArray(), nullptr);
+    }
+
+    EMSCRIPTEN_KEEPALIVE
+    int heapGetArrayInto(int* out, int capacity) {
+        if (!heap || heapJob.busy()) return 0;
+        return resultInto(heap->getArray(), out, capacity);
     }
 
     EMSCRIPTEN_KEEPALIVE
     int heapGetSize() {
-        if (!heap) return 0;
+        if (!heap || heapJob.busy()) return 0;
         return heap->getSize();
     }
-}
 
+    // Returned string stays valid until the next heapGetStats call
+    EMSCRIPTEN_KEEPALIVE
+    const char* heapGetStats() {
+#if DS_ENABLE_STATS
+        if (heapJob.busy()) return DS_STATS_BUSY_JSON;
+        static std::string json;
+        json = heap ? heap->statsJSON() : DSStatsWriter().finish();
+        return json.c_str();
+#else
+        return DS_STATS_DISABLED_JSON;
+#endif
+    }
+
+    EMSCRIPTEN_KEEPALIVE
+    void heapResetStats() {
+#if DS_ENABLE_STATS
+        if (heap && !heapJob.busy()) heap->resetStats();
+#endif
+    }
+}
@@ -0,0 +1,75 @@
+#include <memory>
+#include <mutex>
+#include <set>
+#include <emscripten.h>
+#include "thread_pool.h"
+
+#if DS_THREADS && defined(__EMSCRIPTEN__)
+#include <emscripten/threading.h>
+
+EM_JS(void, notifyJobComplete, (int id), {
+    if (Module.onJobComplete) Module.onJobComplete(id);
+});
+#endif
+
+static std::unique_ptr<ThreadPool> threadPool;
+static std::mutex jobLock;
+static std::set<int> finishedJobs;
+static int nextJobId = 0;
+
+ThreadPool& sharedThreadPool() {
+    if (!threadPool) {
+#if DS_THREADS
+        threadPool.reset(new ThreadPool(std::max(1u, std::thread::hardware_concurrency())));
+#else
+        threadPool.reset(new ThreadPool(0));
+#endif
+    }
+    return *threadPool;
+}
+
+static void finishJob(int id) {
+    {
+        std::lock_guard<std::mutex> guard(jobLock);
+        finishedJobs.insert(id);
+    }
+#if DS_THREADS && defined(__EMSCRIPTEN__)
+    emscripten_async_run_in_main_runtime_thread(EM_FUNC_SIG_VI, notifyJobComplete, id);
+#endif
+}
+
+int jobSubmit(std::function<void()> work) {
+    ThreadPool& pool = sharedThreadPool();
+    int id;
+    {
+        std::lock_guard<std::mutex> guard(jobLock);
+        id = ++nextJobId;
+    }
+    pool.submit([work, id] {
+        work();
+        finishJob(id);
+    });
+    return id;
+}
+
+extern "C" {
+    // Sizes the shared pool; must be called before any job is running.
+    // Ignored by the single-threaded build.
+    EMSCRIPTEN_KEEPALIVE
+    int jobPoolInit(int threadCount) {
+#if DS_THREADS
+        if (threadCount < 1) threadCount = std::max(1u, std::thread::hardware_concurrency());
+        threadPool.reset(new ThreadPool(threadCount));
+#else
+        (void)threadCount;
+#endif
+        return sharedThreadPool().getThreadCount();
+    }
+
+    // Returns 1 once job id has finished and forgets it; 0 while it runs
+    EMSCRIPTEN_KEEPALIVE
+    int jobFinished(int id) {
+        std::lock_guard<std::mutex> guard(jobLock);
+        return finishedJobs.erase(id) ? 1 : 0;
+    }
+}
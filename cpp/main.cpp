@@ -10,13 +10,25 @@ extern "C" {
     int heapDelete();
     void heapClear();
     int* heapGetArray();
+    int heapGetArrayInto(int* out, int capacity);
+    int heapBuildAsync(const int* values, int count);
     int heapGetSize();
+    const char* heapGetStats();
+    void heapResetStats();
 
     // AVL Tree functions
     void createAVLTree();
     void avlInsert(int value);
     void avlDelete(int value);
     void avlClear();
+    int* avlInorder(int* size);
+    int avlInorderInto(int* out, int capacity);
+    int* avlPreorder(int* size);
+    int avlPreorderInto(int* out, int capacity);
+    int* avlPostorder(int* size);
+    int avlPostorderInto(int* out, int capacity);
+    const char* avlGetStats();
+    void avlResetStats();
 
     // Graph functions
     void createGraph();
@@ -25,14 +37,50 @@ extern "C" {
     void graphAddEdge(char from, char to, int weight);
     void graphRemoveEdge(char from, char to);
     void graphClear();
-    int* graphBFS(char start, int* size);
-    int* graphDFS(char start, int* size);
+    char* graphBFS(char start, int* size);
+    int graphBFSInto(char start, char* out, int capacity);
+    char* graphDFS(char start, int* size);
+    int graphDFSInto(char start, char* out, int capacity);
+    int* graphDijkstra(char start, int* size);
+    int graphDijkstraInto(char start, int* out, int capacity);
+    int* graphPrim(char start, int* size);
+    int graphPrimInto(char start, int* out, int capacity);
+    int graphDijkstraAsync(char start);
+    int* graphDijkstraResult(int* size);
+    int graphPrimAsync(char start);
+    int* graphPrimResult(int* size);
+    const char* graphGetStats();
+    void graphResetStats();
 
     // Hash Table functions
     void createHashTable(int size, int useChaining);
     void hashTableInsert(const char* key, const char* value);
     const char* hashTableSearch(const char* key);
+    int hashTableSearchBatch(const int* offsets, const char* keys, int count, const char** results);
+    void hashTableInsertBatch(const int* keyOffsets, const char* keys,
+                              const int* valueOffsets, const char* values, int count);
     int hashTableDelete(const char* key);
     void hashTableClear();
+    int hashTableSave(const char* path);
+    int hashTableOpen(const char* path, int copyOnWrite);
+    int hashTableRehashAsync(int newSize);
+    const char* hashTableGetStats();
+    void hashTableResetStats();
+
+    // Concurrent Hash Table functions
+    void createConcurrentHashTable(int shardCount);
+    void concurrentHashTableInsert(const char* key, const char* value);
+    int concurrentHashTableSearch(const char* key, char* out, int capacity);
+    int concurrentHashTableDelete(const char* key);
+    void concurrentHashTableClear();
+    int concurrentHashTableGetCount();
+
+    // Command batching
+    struct CommandRing* commandRingInit(int capacity, int arenaBytes, int outBytes);
+    int executeBatch(int n);
+
+    // Background jobs
+    int jobPoolInit(int threadCount);
+    int jobFinished(int id);
 }
 
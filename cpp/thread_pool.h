@@ -0,0 +1,196 @@
+#pragma once
+
+// Work-stealing thread pool and background jobs.
+//
+// DS_THREADS is on for the pthreads build (emcc -pthread) and off otherwise.
+// Without it the pool has no workers: submit and parallelFor run inline, so
+// the single-threaded module keeps working unchanged.
+//
+// Each worker owns a deque. It pops its own work LIFO and steals from the
+// other workers FIFO when it runs dry. A thread waiting in parallelFor runs
+// queued tasks instead of blocking, so nested parallel loops cannot deadlock.
+
+#include <algorithm>
+#include <atomic>
+#include <functional>
+
+#ifndef DS_THREADS
+#if defined(__EMSCRIPTEN_PTHREADS__)
+#define DS_THREADS 1
+#else
+#define DS_THREADS 0
+#endif
+#endif
+
+#if DS_THREADS
+#include <condition_variable>
+#include <deque>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+#endif
+
+class ThreadPool {
+public:
+    using Task = std::function<void()>;
+
+#if DS_THREADS
+private:
+    struct Worker {
+        std::mutex lock;
+        std::deque<Task> tasks;
+    };
+
+    std::vector<std::unique_ptr<Worker>> workers;
+    std::vector<std::thread> threads;
+    std::atomic<int> queued{0};
+    std::atomic<unsigned> nextWorker{0};
+    std::atomic<bool> stopping{false};
+    std::mutex sleepLock;
+    std::condition_variable wake;
+
+    static int& currentWorker() {
+        static thread_local int index = -1;
+        return index;
+    }
+
+    bool popTask(int self, Task& task) {
+        int n = workers.size();
+        if (self >= 0) {
+            Worker& own = *workers[self];
+            std::lock_guard<std::mutex> guard(own.lock);
+            if (!own.tasks.empty()) {
+                task = std::move(own.tasks.back());
+                own.tasks.pop_back();
+                return true;
+            }
+        }
+        int start = self >= 0 ? self + 1 : 0;
+        for (int i = 0; i < n; i++) {
+            Worker& victim = *workers[(start + i) % n];
+            std::lock_guard<std::mutex> guard(victim.lock);
+            if (!victim.tasks.empty()) {
+                task = std::move(victim.tasks.front());
+                victim.tasks.pop_front();
+                return true;
+            }
+        }
+        return false;
+    }
+
+    bool runOne() {
+        Task task;
+        if (!popTask(currentWorker(), task)) return false;
+        queued--;
+        task();
+        return true;
+    }
+
+    void workerLoop(int index) {
+        currentWorker() = index;
+        while (!stopping) {
+            if (runOne()) continue;
+            std::unique_lock<std::mutex> lock(sleepLock);
+            wake.wait(lock, [this] { return stopping || queued > 0; });
+        }
+    }
+
+public:
+    explicit ThreadPool(int threadCount) {
+        if (threadCount < 1) threadCount = 1;
+        for (int i = 0; i < threadCount; i++) {
+            workers.emplace_back(new Worker());
+        }
+        for (int i = 0; i < threadCount; i++) {
+            threads.emplace_back(&ThreadPool::workerLoop, this, i);
+        }
+    }
+
+    ~ThreadPool() {
+        {
+            std::lock_guard<std::mutex> guard(sleepLock);
+            stopping = true;
+        }
+        wake.notify_all();
+        for (std::thread& thread : threads) thread.join();
+    }
+
+    int getThreadCount() { return threads.size(); }
+
+    void submit(Task task) {
+        int self = currentWorker();
+        int target = self >= 0 ? self : nextWorker++ % workers.size();
+        {
+            std::lock_guard<std::mutex> guard(workers[target]->lock);
+            workers[target]->tasks.push_back(std::move(task));
+        }
+        queued++;
+        // Taking the sleep lock orders this wake-up after any worker's
+        // predicate check, so the notification cannot be lost
+        { std::lock_guard<std::mutex> guard(sleepLock); }
+        wake.notify_one();
+    }
+
+    // Calls body(i) for every i in [begin, end), in chunks of grain
+    template <typename Body>
+    void parallelFor(int begin, int end, int grain, Body body) {
+        if (end - begin <= grain) {
+            for (int i = begin; i < end; i++) body(i);
+            return;
+        }
+        std::atomic<int> remaining{0};
+        for (int chunk = begin + grain; chunk < end; chunk += grain) {
+            int chunkEnd = std::min(chunk + grain, end);
+            remaining++;
+            submit([&remaining, &body, chunk, chunkEnd] {
+                for (int i = chunk; i < chunkEnd; i++) body(i);
+                remaining--;
+            });
+        }
+        for (int i = begin; i < begin + grain; i++) body(i);
+        while (remaining > 0) {
+            if (!runOne()) std::this_thread::yield();
+        }
+    }
+#else
+public:
+    explicit ThreadPool(int) {}
+
+    int getThreadCount() { return 0; }
+
+    void submit(Task task) { task(); }
+
+    template <typename Body>
+    void parallelFor(int begin, int end, int, Body body) {
+        for (int i = begin; i < end; i++) body(i);
+    }
+#endif
+
+    ThreadPool(const ThreadPool&) = delete;
+    ThreadPool& operator=(const ThreadPool&) = delete;
+};
+
+// Held by a background job for the structure it works on. Every export of
+// that structure checks busy() first and refuses to run, returning its
+// empty value, until the job releases it; an *Async export returns -1
+// instead of a job id. Exports are called from one thread, so a check
+// cannot race with a job being started.
+class JobOwnership {
+private:
+    std::atomic<bool> owned{false};
+
+public:
+    bool tryAcquire() { return !owned.exchange(true, std::memory_order_acquire); }
+    void release() { owned.store(false, std::memory_order_release); }
+    bool busy() const { return owned.load(std::memory_order_acquire); }
+};
+
+// Both defined in jobs.cpp.
+ThreadPool& sharedThreadPool();
+
+// Runs work on the shared pool and returns a job id. When it finishes,
+// jobFinished(id) turns true and Module.onJobComplete(id) is called on the
+// main thread. work must release its structure's JobOwnership before it
+// returns, so the structure is usable again once the job is reported done.
+int jobSubmit(std::function<void()> work);
@@ -0,0 +1,62 @@
+// Headless tests for the wasmAsync promise API.
+//
+//   node --test test/
+//
+// Needs a ds_visualizer.js built with the job exports and HEAP32 (see the
+// README). The pthreads build runs the jobs on worker_threads; the
+// single-threaded build runs each one inline. A stale build fails every test.
+const test = require('node:test');
+const assert = require('node:assert');
+const path = require('path');
+const { loadWasmNode, wasmFunctions, wasmAsync, getModule } = require('../wasm-wrapper.js');
+
+const ready = loadWasmNode(path.join(__dirname, '..', 'ds_visualizer.js'));
+
+async function requireJobs() {
+    await ready;
+    if (!wasmFunctions.heapBuildAsync || !getModule().HEAP32) {
+        assert.fail('ds_visualizer.js predates the job exports; rebuild it as described in README.md');
+    }
+}
+
+test('heapBuild resolves with a valid heap', async () => {
+    await requireJobs();
+    wasmFunctions.createHeap(1);
+    const values = Array.from({ length: 5000 }, (_, i) => (i * 7919) % 5003);
+    await wasmAsync.heapBuild(values);
+    assert.strictEqual(wasmFunctions.heapGetSize(), values.length);
+    const drained = [];
+    for (let i = 0; i < values.length; i++) drained.push(wasmFunctions.heapDelete());
+    assert.deepStrictEqual(drained, [...values].sort((a, b) => a - b));
+});
+
+test('overlapping graph jobs each see their own result', async () => {
+    await requireJobs();
+    wasmFunctions.createGraph();
+    for (const node of 'ABCD') wasmFunctions.graphAddNode(node.charCodeAt(0));
+    const edges = [['A', 'B', 1], ['B', 'C', 2], ['A', 'C', 5], ['C', 'D', 1]];
+    for (const [from, to, weight] of edges) {
+        wasmFunctions.graphAddEdge(from.charCodeAt(0), to.charCodeAt(0), weight);
+        wasmFunctions.graphAddEdge(to.charCodeAt(0), from.charCodeAt(0), weight);
+    }
+
+    const [fromA, mst, fromD] = await Promise.all([
+        wasmAsync.graphDijkstra('A'),
+        wasmAsync.graphPrim('A'),
+        wasmAsync.graphDijkstra('D')
+    ]);
+    assert.deepStrictEqual(fromA, { A: 0, B: 1, C: 3, D: 4 });
+    assert.deepStrictEqual(fromD, { A: 4, B: 3, C: 1, D: 0 });
+    assert.strictEqual(mst.length, 3);
+    assert.strictEqual(mst.reduce((total, edge) => total + edge.weight, 0), 4);
+});
+
+test('hashTableRehash keeps every entry reachable', async () => {
+    await requireJobs();
+    wasmFunctions.createHashTable(11, 1);
+    for (let i = 0; i < 200; i++) wasmFunctions.hashTableInsert('key' + i, 'value' + i);
+    await Promise.all([wasmAsync.hashTableRehash(97), wasmAsync.hashTableRehash(389)]);
+    for (let i = 0; i < 200; i++) {
+        assert.strictEqual(wasmFunctions.hashTableSearch('key' + i), 'value' + i);
+    }
+});
@@ -10,13 +10,24 @@ let wasmFunctions = {
     heapDelete: null,
     heapClear: null,
     heapGetArray: null,
+    heapGetArrayInto: null,
     heapGetSize: null,
+    heapGetStats: null,
+    heapResetStats: null,
     
     // AVL Tree functions
     createAVLTree: null,
     avlInsert: null,
     avlDelete: null,
     avlClear: null,
+    avlInorder: null,
+    avlInorderInto: null,
+    avlPreorder: null,
+    avlPreorderInto: null,
+    avlPostorder: null,
+    avlPostorderInto: null,
+    avlGetStats: null,
+    avlResetStats: null,
     
     // Graph functions
     createGraph: null,
@@ -26,14 +37,50 @@ let wasmFunctions = {
     graphRemoveEdge: null,
     graphClear: null,
     graphBFS: null,
+    graphBFSInto: null,
     graphDFS: null,
+    graphDFSInto: null,
+    graphDijkstra: null,
+    graphDijkstraInto: null,
+    graphPrim: null,
+    graphPrimInto: null,
+    graphGetStats: null,
+    graphResetStats: null,
     
     // Hash Table functions
     createHashTable: null,
     hashTableInsert: null,
     hashTableSearch: null,
+    hashTableSearchBatch: null,
+    hashTableInsertBatch: null,
     hashTableDelete: null,
     hashTableClear: null,
+    hashTableSave: null,
+    hashTableOpen: null,
+    hashTableGetStats: null,
+    hashTableResetStats: null,
+    
+    // Concurrent Hash Table functions
+    createConcurrentHashTable: null,
+    concurrentHashTableInsert: null,
+    concurrentHashTableSearch: null,
+    concurrentHashTableDelete: null,
+    concurrentHashTableClear: null,
+    concurrentHashTableGetCount: null,
+    
+    // Command batching
+    commandRingInit: null,
+    executeBatch: null,
+    
+    // Background jobs (parallel in the pthreads build)
+    jobPoolInit: null,
+    jobFinished: null,
+    heapBuildAsync: null,
+    graphDijkstraAsync: null,
+    graphDijkstraResult: null,
+    graphPrimAsync: null,
+    graphPrimResult: null,
+    hashTableRehashAsync: null,
     
     // Memory management
     malloc: null,
@@ -42,50 +89,327 @@ let wasmFunctions = {
     stringToUTF8: null
 };
 
+// Opcodes understood by executeBatch (must match cpp/command_batch.cpp)
+const CommandOp = {
+    HEAP_CREATE: 1, HEAP_INSERT: 2, HEAP_DELETE: 3, HEAP_CLEAR: 4, HEAP_SIZE: 5,
+    AVL_CREATE: 16, AVL_INSERT: 17, AVL_DELETE: 18, AVL_CLEAR: 19,
+    GRAPH_CREATE: 32, GRAPH_ADD_NODE: 33, GRAPH_REMOVE_NODE: 34,
+    GRAPH_ADD_EDGE: 35, GRAPH_REMOVE_EDGE: 36, GRAPH_CLEAR: 37,
+    HASH_CREATE: 48, HASH_INSERT: 49, HASH_SEARCH: 50, HASH_DELETE: 51, HASH_CLEAR: 52
+};
+
+// Queues commands in the shared ring and runs them with one executeBatch call.
+// Results are {status, value}; status 0 is success, and for HASH_SEARCH the
+// value is the found string (null if absent). Status -3 means the batch's
+// out area could not hold the string. A full ring or arena is drained
+// early; those results are kept and returned by the next flush().
+class CommandBatch {
+    constructor(capacity = 4096, arenaBytes = 1 << 16, outBytes = 1 << 16) {
+        this.header = wasmFunctions.commandRingInit(capacity, arenaBytes, outBytes) >> 2;
+        const h = Module.HEAPU32;
+        this.capacity = h[this.header];
+        this.arenaCapacity = h[this.header + 3];
+        this.commands = h[this.header + 5] >> 2;
+        this.results = h[this.header + 6] >> 2;
+        this.arena = h[this.header + 7];
+        this.out = h[this.header + 10];
+        this.encoder = new TextEncoder();
+        this.decoder = new TextDecoder();
+        this.writeIndex = 0;
+        this.arenaUsed = 0;
+        this.queued = [];
+        this.completed = [];
+    }
+
+    push(opcode, a = 0, b = 0, c = 0) {
+        if (this.queued.length === this.capacity) this.drain();
+        // Re-read HEAP32 each time: memory growth replaces the buffer
+        const heap = Module.HEAP32;
+        const slot = this.commands + (this.writeIndex & (this.capacity - 1)) * 4;
+        heap[slot] = opcode;
+        heap[slot + 1] = a;
+        heap[slot + 2] = b;
+        heap[slot + 3] = c;
+        this.queued.push({ index: this.writeIndex, opcode });
+        this.writeIndex++;
+    }
+
+    hashInsert(key, value) {
+        const [k, v] = this.strings(key, value);
+        this.push(CommandOp.HASH_INSERT, k, v);
+    }
+
+    hashSearch(key) {
+        const [k] = this.strings(key);
+        this.push(CommandOp.HASH_SEARCH, k);
+    }
+
+    hashDelete(key) {
+        const [k] = this.strings(key);
+        this.push(CommandOp.HASH_DELETE, k);
+    }
+
+    // Encodes strings straight into the arena for the command about to be
+    // pushed, draining first if the ring is full and retrying after a drain
+    // if the arena cannot take them all
+    strings(...strs) {
+        if (this.queued.length === this.capacity) this.drain();
+        for (;;) {
+            const offsets = this.writeStrings(strs);
+            if (offsets) return offsets;
+            if (this.queued.length === 0) throw new RangeError('strings larger than command arena');
+            this.drain();
+        }
+    }
+
+    // Returns the arena offsets, or null (arena unchanged) if they do not fit
+    writeStrings(strs) {
+        const heap = Module.HEAPU8;
+        const end = this.arena + this.arenaCapacity;
+        const offsets = [];
+        let used = this.arenaUsed;
+        for (const str of strs) {
+            const start = this.arena + used;
+            if (start >= end) return null;
+            // Keep the last byte free for the terminating NUL
+            const { read, written } = this.encoder.encodeInto(str, heap.subarray(start, end - 1));
+            if (read < str.length) return null;
+            heap[start + written] = 0;
+            offsets.push(used);
+            used += written + 1;
+        }
+        this.arenaUsed = used;
+        return offsets;
+    }
+
+    drain() {
+        const h = Module.HEAPU32;
+        h[this.header + 2] = this.writeIndex;
+        h[this.header + 4] = this.arenaUsed;
+        wasmFunctions.executeBatch(this.queued.length);
+
+        // Decode returned strings now: the next batch reuses the out area
+        const heap = Module.HEAP32;
+        const bytes = Module.HEAPU8;
+        for (const { index, opcode } of this.queued) {
+            const slot = this.results + (index & (this.capacity - 1)) * 3;
+            const status = heap[slot];
+            let value = heap[slot + 1];
+            if (opcode === CommandOp.HASH_SEARCH && status === 0) {
+                const start = this.out + value;
+                value = value < 0 ? null : this.decoder.decode(bytes.subarray(start, start + heap[slot + 2]));
+            }
+            this.completed.push({ status, value });
+        }
+        this.queued = [];
+        this.arenaUsed = 0;
+    }
+
+    // Runs everything queued so far and returns all results in push order
+    flush() {
+        this.drain();
+        const out = this.completed;
+        this.completed = [];
+        return out;
+    }
+}
+
+// Background jobs. Each *Async export returns a job id; the module calls
+// Module.onJobComplete(id) on the main thread when the job is done. While a
+// job is pending, the direct calls on its structure are refused and return
+// empty values, and another *Async call on it returns -1 instead of an id.
+const pendingJobs = new Map();
+
+function waitForJob(id) {
+    return new Promise((resolve, reject) => {
+        if (id < 0) {
+            reject(new Error('structure is busy with another job'));
+        } else if (wasmFunctions.jobFinished(id)) {
+            // The single-threaded build finishes jobs before returning the id
+            resolve();
+        } else {
+            pendingJobs.set(id, resolve);
+        }
+    });
+}
+
+function onJobComplete(id) {
+    const resolve = pendingJobs.get(id);
+    if (resolve && wasmFunctions.jobFinished(id)) {
+        pendingJobs.delete(id);
+        resolve();
+    }
+}
+
+// Slot the result views write their size into; allocated once at bind time
+let resultSizePtr = 0;
+
+// Copies a result view (see cpp/ds_result_buffer.h) into a JS array
+function readIntResult(viewFn) {
+    const ptr = viewFn(resultSizePtr);
+    const size = Module.HEAP32[resultSizePtr >> 2];
+    return ptr ? Array.from(Module.HEAP32.subarray(ptr >> 2, (ptr >> 2) + size)) : [];
+}
+
+// Jobs on one structure share its result buffers and stats, so each
+// structure runs one job at a time; later calls queue behind earlier ones.
+const jobChains = {};
+
+function runSerialized(structure, startJob) {
+    const previous = jobChains[structure] || Promise.resolve();
+    const next = previous.then(startJob);
+    jobChains[structure] = next.catch(() => {});
+    return next;
+}
+
+const wasmAsync = {
+    heapBuild(values) {
+        return runSerialized('heap', () => {
+            const ptr = wasmFunctions.malloc(values.length * 4);
+            Module.HEAP32.set(values, ptr >> 2);
+            // The module copies the values before the job starts
+            const id = wasmFunctions.heapBuildAsync(ptr, values.length);
+            wasmFunctions.free(ptr);
+            return waitForJob(id);
+        });
+    },
+
+    // Resolves to {node: distance}; unreachable nodes are Infinity
+    graphDijkstra(start) {
+        return runSerialized('graph', () => {
+            const id = wasmFunctions.graphDijkstraAsync(start.charCodeAt(0));
+            return waitForJob(id).then(() => {
+                const flat = readIntResult(wasmFunctions.graphDijkstraResult);
+                const distances = {};
+                for (let i = 0; i < flat.length; i += 2) {
+                    distances[String.fromCharCode(flat[i])] = flat[i + 1] === 2147483647 ? Infinity : flat[i + 1];
+                }
+                return distances;
+            });
+        });
+    },
+
+    // Resolves to the MST edges as [{from, to, weight}]
+    graphPrim(start) {
+        return runSerialized('graph', () => {
+            const id = wasmFunctions.graphPrimAsync(start.charCodeAt(0));
+            return waitForJob(id).then(() => {
+                const flat = readIntResult(wasmFunctions.graphPrimResult);
+                const edges = [];
+                for (let i = 0; i < flat.length; i += 3) {
+                    edges.push({ from: String.fromCharCode(flat[i]), to: String.fromCharCode(flat[i + 1]), weight: flat[i + 2] });
+                }
+                return edges;
+            });
+        });
+    },
+
+    hashTableRehash(newSize) {
+        return runSerialized('hashTable', () => waitForJob(wasmFunctions.hashTableRehashAsync(newSize)));
+    }
+};
+
+// Create function wrappers once the runtime is up
+function bindWasmFunctions() {
+    wasmFunctions.createHeap = Module.cwrap('createHeap', null, ['number']);
+    wasmFunctions.heapInsert = Module.cwrap('heapInsert', null, ['number']);
+    wasmFunctions.heapDelete = Module.cwrap('heapDelete', 'number', []);
+    wasmFunctions.heapClear = Module.cwrap('heapClear', null, []);
+    wasmFunctions.heapGetArray = Module.cwrap('heapGetArray', 'number', []);
+    wasmFunctions.heapGetArrayInto = Module.cwrap('heapGetArrayInto', 'number', ['number', 'number']);
+    wasmFunctions.heapGetSize = Module.cwrap('heapGetSize', 'number', []);
+    wasmFunctions.heapGetStats = Module.cwrap('heapGetStats', 'string', []);
+    wasmFunctions.heapResetStats = Module.cwrap('heapResetStats', null, []);
+
+    wasmFunctions.createAVLTree = Module.cwrap('createAVLTree', null, []);
+    wasmFunctions.avlInsert = Module.cwrap('avlInsert', null, ['number']);
+    wasmFunctions.avlDelete = Module.cwrap('avlDelete', null, ['number']);
+    wasmFunctions.avlClear = Module.cwrap('avlClear', null, []);
+    wasmFunctions.avlInorder = Module.cwrap('avlInorder', 'number', ['number']);
+    wasmFunctions.avlInorderInto = Module.cwrap('avlInorderInto', 'number', ['number', 'number']);
+    wasmFunctions.avlPreorder = Module.cwrap('avlPreorder', 'number', ['number']);
+    wasmFunctions.avlPreorderInto = Module.cwrap('avlPreorderInto', 'number', ['number', 'number']);
+    wasmFunctions.avlPostorder = Module.cwrap('avlPostorder', 'number', ['number']);
+    wasmFunctions.avlPostorderInto = Module.cwrap('avlPostorderInto', 'number', ['number', 'number']);
+    wasmFunctions.avlGetStats = Module.cwrap('avlGetStats', 'string', []);
+    wasmFunctions.avlResetStats = Module.cwrap('avlResetStats', null, []);
+
+    wasmFunctions.createGraph = Module.cwrap('createGraph', null, []);
+    wasmFunctions.graphAddNode = Module.cwrap('graphAddNode', null, ['number']);
+    wasmFunctions.graphRemoveNode = Module.cwrap('graphRemoveNode', null, ['number']);
+    wasmFunctions.graphAddEdge = Module.cwrap('graphAddEdge', null, ['number', 'number', 'number']);
+    wasmFunctions.graphRemoveEdge = Module.cwrap('graphRemoveEdge', null, ['number', 'number']);
+    wasmFunctions.graphClear = Module.cwrap('graphClear', null, []);
+    wasmFunctions.graphBFS = Module.cwrap('graphBFS', 'number', ['number', 'number']);
+    wasmFunctions.graphBFSInto = Module.cwrap('graphBFSInto', 'number', ['number', 'number', 'number']);
+    wasmFunctions.graphDFS = Module.cwrap('graphDFS', 'number', ['number', 'number']);
+    wasmFunctions.graphDFSInto = Module.cwrap('graphDFSInto', 'number', ['number', 'number', 'number']);
+    wasmFunctions.graphDijkstra = Module.cwrap('graphDijkstra', 'number', ['number', 'number']);
+    wasmFunctions.graphDijkstraInto = Module.cwrap('graphDijkstraInto', 'number', ['number', 'number', 'number']);
+    wasmFunctions.graphPrim = Module.cwrap('graphPrim', 'number', ['number', 'number']);
+    wasmFunctions.graphPrimInto = Module.cwrap('graphPrimInto', 'number', ['number', 'number', 'number']);
+    wasmFunctions.graphGetStats = Module.cwrap('graphGetStats', 'string', []);
+    wasmFunctions.graphResetStats = Module.cwrap('graphResetStats', null, []);
+
+    wasmFunctions.createHashTable = Module.cwrap('createHashTable', null, ['number', 'number']);
+    wasmFunctions.hashTableInsert = Module.cwrap('hashTableInsert', null, ['string', 'string']);
+    wasmFunctions.hashTableSearch = Module.cwrap('hashTableSearch', 'string', ['string']);
+    wasmFunctions.hashTableSearchBatch = Module.cwrap('hashTableSearchBatch', 'number', ['number', 'number', 'number', 'number']);
+    wasmFunctions.hashTableInsertBatch = Module.cwrap('hashTableInsertBatch', null, ['number', 'number', 'number', 'number', 'number']);
+    wasmFunctions.hashTableDelete = Module.cwrap('hashTableDelete', 'number', ['string']);
+    wasmFunctions.hashTableClear = Module.cwrap('hashTableClear', null, []);
+    wasmFunctions.hashTableSave = Module.cwrap('hashTableSave', 'number', ['string']);
+    wasmFunctions.hashTableOpen = Module.cwrap('hashTableOpen', 'number', ['string', 'number']);
+    wasmFunctions.hashTableGetStats = Module.cwrap('hashTableGetStats', 'string', []);
+    wasmFunctions.hashTableResetStats = Module.cwrap('hashTableResetStats', null, []);
+
+    wasmFunctions.createConcurrentHashTable = Module.cwrap('createConcurrentHashTable', null, ['number']);
+    wasmFunctions.concurrentHashTableInsert = Module.cwrap('concurrentHashTableInsert', null, ['string', 'string']);
+    wasmFunctions.concurrentHashTableSearch = Module.cwrap('concurrentHashTableSearch', 'number', ['string', 'number', 'number']);
+    wasmFunctions.concurrentHashTableDelete = Module.cwrap('concurrentHashTableDelete', 'number', ['string']);
+    wasmFunctions.concurrentHashTableClear = Module.cwrap('concurrentHashTableClear', null, []);
+    wasmFunctions.concurrentHashTableGetCount = Module.cwrap('concurrentHashTableGetCount', 'number', []);
+
+    wasmFunctions.commandRingInit = Module.cwrap('commandRingInit', 'number', ['number', 'number', 'number']);
+    wasmFunctions.executeBatch = Module.cwrap('executeBatch', 'number', ['number']);
+
+    wasmFunctions.jobPoolInit = Module.cwrap('jobPoolInit', 'number', ['number']);
+    wasmFunctions.jobFinished = Module.cwrap('jobFinished', 'number', ['number']);
+    wasmFunctions.heapBuildAsync = Module.cwrap('heapBuildAsync', 'number', ['number', 'number']);
+    wasmFunctions.graphDijkstraAsync = Module.cwrap('graphDijkstraAsync', 'number', ['number']);
+    wasmFunctions.graphDijkstraResult = Module.cwrap('graphDijkstraResult', 'number', ['number']);
+    wasmFunctions.graphPrimAsync = Module.cwrap('graphPrimAsync', 'number', ['number']);
+    wasmFunctions.graphPrimResult = Module.cwrap('graphPrimResult', 'number', ['number']);
+    wasmFunctions.hashTableRehashAsync = Module.cwrap('hashTableRehashAsync', 'number', ['number']);
+
+    wasmFunctions.malloc = Module.cwrap('malloc', 'number', ['number']);
+    wasmFunctions.free = Module.cwrap('free', null, ['number']);
+    wasmFunctions.UTF8ToString = Module.UTF8ToString;
+    wasmFunctions.stringToUTF8 = Module.stringToUTF8;
+
+    if (!resultSizePtr) resultSizePtr = wasmFunctions.malloc(4);
+}
+
+// Module config shared by the browser and Node loaders
+function createModuleConfig(resolve) {
+    const config = {
+        onJobComplete: onJobComplete,
+        onRuntimeInitialized: function() {
+            Module = config;
+            bindWasmFunctions();
+            wasmReady = true;
+            console.log('WebAssembly module initialized');
+            resolve();
+        }
+    };
+    return config;
+}
+
 // Initialize WebAssembly module
 function initWasm() {
     return new Promise((resolve, reject) => {
         if (typeof Module === 'undefined') {
-            Module = {
-                onRuntimeInitialized: function() {
-                    // Create function wrappers
-                    wasmFunctions.createHeap = Module.cwrap('createHeap', null, ['number']);
-                    wasmFunctions.heapInsert = Module.cwrap('heapInsert', null, ['number']);
-                    wasmFunctions.heapDelete = Module.cwrap('heapDelete', 'number', []);
-                    wasmFunctions.heapClear = Module.cwrap('heapClear', null, []);
-                    wasmFunctions.heapGetArray = Module.cwrap('heapGetArray', 'number', []);
-                    wasmFunctions.heapGetSize = Module.cwrap('heapGetSize', 'number', []);
-                    
-                    wasmFunctions.createAVLTree = Module.cwrap('createAVLTree', null, []);
-                    wasmFunctions.avlInsert = Module.cwrap('avlInsert', null, ['number']);
-                    wasmFunctions.avlDelete = Module.cwrap('avlDelete', null, ['number']);
-                    wasmFunctions.avlClear = Module.cwrap('avlClear', null, []);
-                    
-                    wasmFunctions.createGraph = Module.cwrap('createGraph', null, []);
-                    wasmFunctions.graphAddNode = Module.cwrap('graphAddNode', null, ['number']);
-                    wasmFunctions.graphRemoveNode = Module.cwrap('graphRemoveNode', null, ['number']);
-                    wasmFunctions.graphAddEdge = Module.cwrap('graphAddEdge', null, ['number', 'number', 'number']);
-                    wasmFunctions.graphRemoveEdge = Module.cwrap('graphRemoveEdge', null, ['number', 'number']);
-                    wasmFunctions.graphClear = Module.cwrap('graphClear', null, []);
-                    wasmFunctions.graphBFS = Module.cwrap('graphBFS', 'number', ['number', 'number']);
-                    wasmFunctions.graphDFS = Module.cwrap('graphDFS', 'number', ['number', 'number']);
-                    
-                    wasmFunctions.createHashTable = Module.cwrap('createHashTable', null, ['number', 'number']);
-                    wasmFunctions.hashTableInsert = Module.cwrap('hashTableInsert', null, ['string', 'string']);
-                    wasmFunctions.hashTableSearch = Module.cwrap('hashTableSearch', 'string', ['string']);
-                    wasmFunctions.hashTableDelete = Module.cwrap('hashTableDelete', 'number', ['string']);
-                    wasmFunctions.hashTableClear = Module.cwrap('hashTableClear', null, []);
-                    
-                    wasmFunctions.malloc = Module.cwrap('malloc', 'number', ['number']);
-                    wasmFunctions.free = Module.cwrap('free', null, ['number']);
-                    wasmFunctions.UTF8ToString = Module.UTF8ToString;
-                    wasmFunctions.stringToUTF8 = Module.stringToUTF8;
-                    
-                    wasmReady = true;
-                    console.log('WebAssembly module initialized');
-                    resolve();
-                }
-            };
+            Module = createModuleConfig(resolve);
             
             // Load the WebAssembly module
             const script = document.createElement('script');
@@ -104,10 +428,32 @@ function initWasm() {
     });
 }
 
+// Loads the module under Node and resolves once wasmFunctions is bound.
+// The emscripten output is not modularized: it picks up a Module config
+// from its scope, but when required as CommonJS it exports a fresh object
+// instead. Evaluating the script with our config in scope keeps it.
+function loadWasmNode(scriptPath) {
+    const fs = require('fs');
+    const path = require('path');
+    const file = path.resolve(scriptPath || path.join(__dirname, 'ds_visualizer.js'));
+    return new Promise((resolve, reject) => {
+        const config = createModuleConfig(resolve);
+        config.onAbort = reject;
+        const source = fs.readFileSync(file, 'utf8');
+        const run = new Function('Module', 'require', '__filename', '__dirname', source + '\nreturn Module;');
+        Module = run(config, require, file, path.dirname(file));
+    });
+}
+
 // Initialize on page load
-if (document.readyState === 'loading') {
-    document.addEventListener('DOMContentLoaded', initWasm);
-} else {
-    initWasm();
+if (typeof document !== 'undefined') {
+    if (document.readyState === 'loading') {
+        document.addEventListener('DOMContentLoaded', initWasm);
+    } else {
+        initWasm();
+    }
 }
 
+if (typeof module !== 'undefined' && module.exports) {
+    module.exports = { loadWasmNode, wasmFunctions, wasmAsync, CommandBatch, CommandOp, getModule: () => Module };
+}